@@ -1,8 +1,411 @@
 #include <iostream>
 #include <vector>
+#include <forward_list>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <new>
+#include <iterator>
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <memory_resource>
+
+// Vector carry kernels need x86-64 and GCC-style target attributes; define BIGINTEGER_NO_SIMD to keep the scalar ones
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(BIGINTEGER_NO_SIMD)
+#define BIGINTEGER_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// Fully unrolls the fixed-count limb loops of FixedBigInt, which -O2 would otherwise leave rolled
+#if defined(__clang__)
+#define BIGINTEGER_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define BIGINTEGER_UNROLL _Pragma("GCC unroll 64")
+#else
+#define BIGINTEGER_UNROLL
+#endif
+
+// Keeps the heap path of LimbVector out of line so the inline-limb fast path stays small
+#if defined(__GNUC__) || defined(__clang__)
+#define BIGINTEGER_NOINLINE __attribute__((noinline))
+#else
+#define BIGINTEGER_NOINLINE
+#endif
+
+// Limbs kept inside the BigInteger object before its digits spill to the heap
+#ifndef BIGINTEGER_INLINE_LIMBS
+#define BIGINTEGER_INLINE_LIMBS 4
+#endif
 
 typedef long long ll;
+typedef uint64_t limb;
+typedef unsigned __int128 dlimb;
+
+// Sends the limb buffers this thread allocates to resource until the scope ends: for instance a
+// std::pmr::unsynchronized_pool_resource as a per-thread size-class pool, or a
+// std::pmr::monotonic_buffer_resource as an arena released in bulk afterwards. Any memory_resource
+// plugs in. A buffer goes back to the resource it came from, whatever scope is current by then, so
+// values must not outlive their resource: copy results out after the scope, a copy allocates anew.
+// The pool of BigInteger::setThreadPool may free buffers on its own threads, so pair it with a
+// synchronized resource.
+class BigIntegerMemoryScope {
+public:
+    explicit BigIntegerMemoryScope(std::pmr::memory_resource* resource) : _previous(_current) {_current = resource;}
+    ~BigIntegerMemoryScope() {_current = _previous;}
+    BigIntegerMemoryScope(const BigIntegerMemoryScope&) = delete;
+    BigIntegerMemoryScope& operator = (const BigIntegerMemoryScope&) = delete;
+    // nullptr, outside of any scope, means malloc and free
+    static std::pmr::memory_resource* current() {return _current;}
+
+private:
+    std::pmr::memory_resource* _previous;
+    static thread_local std::pmr::memory_resource* _current;
+};
+
+thread_local std::pmr::memory_resource* BigIntegerMemoryScope::_current = nullptr;
+
+// A size-class pool for one thread to put in a BigIntegerMemoryScope: blocks are rounded up to a
+// power of two, and freed ones wait on a list per size to be handed out again. Limb buffers grow by
+// doubling anyway, so little is lost to the rounding. Nothing is locked; cached blocks go back
+// upstream on release() or destruction.
+class BigIntegerLimbPool : public std::pmr::memory_resource {
+public:
+    explicit BigIntegerLimbPool(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : _upstream(upstream), _free() {}
+    ~BigIntegerLimbPool() {release();}
+    BigIntegerLimbPool(const BigIntegerLimbPool&) = delete;
+    BigIntegerLimbPool& operator = (const BigIntegerLimbPool&) = delete;
+    void release();
+
+private:
+    // Class c holds blocks of 2^c bytes, from 16 up
+    static constexpr size_t _classes = 64;
+    std::pmr::memory_resource* _upstream;
+    void* _free[_classes];
+
+    static size_t sizeClass(size_t bytes) {return bytes <= 16 ? 4 : 64 - __builtin_clzll(bytes - 1);}
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* block, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {return this == &other;}
+};
+
+// Each free block keeps the next one of its list in its first bytes
+void* BigIntegerLimbPool::do_allocate(size_t bytes, size_t alignment) {
+    size_t c = sizeClass(bytes);
+    if (_free[c]) {
+        void* block = _free[c];
+        std::memcpy(&_free[c], block, sizeof(void*));
+        return block;
+    }
+    return _upstream->allocate(static_cast<size_t>(1) << c, std::max(alignment, alignof(void*)));
+}
+
+void BigIntegerLimbPool::do_deallocate(void* block, size_t bytes, size_t) {
+    size_t c = sizeClass(bytes);
+    std::memcpy(block, &_free[c], sizeof(void*));
+    _free[c] = block;
+}
+
+void BigIntegerLimbPool::release() {
+    for (size_t c = 0; c < _classes; ++c) {
+        while (_free[c]) {
+            void* block = _free[c];
+            std::memcpy(&_free[c], block, sizeof(void*));
+            _upstream->deallocate(block, static_cast<size_t>(1) << c, alignof(void*));
+        }
+    }
+}
+
+// A limb_vector look-alike that stores up to N limbs in place and only allocates past that
+template <size_t N>
+class LimbVector {
+    static_assert(N > 0, "LimbVector needs room for at least one inline limb");
+public:
+    typedef limb value_type;
+    typedef limb* iterator;
+    typedef const limb* const_iterator;
+
+    LimbVector() : _data(_inline), _size(0), _capacity(N) {}
+    explicit LimbVector(size_t count, limb value = 0) : LimbVector() {assign(count, value);}
+    template <class It, typename = typename std::enable_if<!std::is_integral<It>::value>::type>
+    LimbVector(It first, It last) : LimbVector() {assign(first, last);}
+    LimbVector(const LimbVector& other) : LimbVector() {assign(other.begin(), other.end());}
+    LimbVector(LimbVector&& other) noexcept : LimbVector() {steal(other);}
+    ~LimbVector() {release();}
+
+    LimbVector& operator = (const LimbVector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    LimbVector& operator = (LimbVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            _data = _inline;
+            _capacity = N;
+            steal(other);
+        }
+        return *this;
+    }
+
+    size_t size() const {return _size;}
+    bool empty() const {return _size == 0;}
+    size_t capacity() const {return _capacity;}
+    limb* data() {return _data;}
+    const limb* data() const {return _data;}
+    limb& operator[](size_t i) {return _data[i];}
+    const limb& operator[](size_t i) const {return _data[i];}
+    limb& back() {return _data[_size - 1];}
+    const limb& back() const {return _data[_size - 1];}
+    iterator begin() {return _data;}
+    iterator end() {return _data + _size;}
+    const_iterator begin() const {return _data;}
+    const_iterator end() const {return _data + _size;}
+
+    void reserve(size_t count) {
+        if (count <= _capacity) {
+            return;
+        }
+        limb* fresh = allocate(count);
+        if (_size) {
+            std::memcpy(fresh, _data, _size * sizeof(limb));
+        }
+        release();
+        _data = fresh;
+        _capacity = count;
+    }
+    void resize(size_t count, limb value = 0) {
+        if (count > _size) {
+            grow(count);
+            std::fill(_data + _size, _data + count, value);
+        }
+        _size = count;
+    }
+    void assign(size_t count, limb value) {
+        _size = 0;
+        resize(count, value);
+    }
+    template <class It, typename = typename std::enable_if<!std::is_integral<It>::value>::type>
+    void assign(It first, It last) {
+        size_t count = std::distance(first, last);
+        _size = 0;
+        grow(count);
+        std::copy(first, last, _data);
+        _size = count;
+    }
+    void clear() {_size = 0;}
+    void push_back(limb value) {
+        if (_size == _capacity) {
+            grow(_size + 1);
+        }
+        _data[_size++] = value;
+    }
+    void pop_back() {--_size;}
+    iterator insert(const_iterator pos, size_t count, limb value) {
+        size_t at = open(pos, count);
+        std::fill(_data + at, _data + at + count, value);
+        return _data + at;
+    }
+    template <class It, typename = typename std::enable_if<!std::is_integral<It>::value>::type>
+    iterator insert(const_iterator pos, It first, It last) {
+        // Copy first: the range may live inside this vector
+        LimbVector items(first, last);
+        size_t at = open(pos, items.size());
+        std::copy(items.begin(), items.end(), _data + at);
+        return _data + at;
+    }
+    iterator erase(const_iterator first, const_iterator last) {
+        size_t at = first - _data;
+        size_t count = last - first;
+        std::copy(_data + at + count, _data + _size, _data + at);
+        _size -= count;
+        return _data + at;
+    }
+    void swap(LimbVector& other) noexcept {
+        if (_data != _inline && other._data != other._inline) {
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+            std::swap(_capacity, other._capacity);
+            return;
+        }
+        LimbVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    friend bool operator == (const LimbVector& lhs, const LimbVector& rhs) {
+        return lhs._size == rhs._size && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+    friend bool operator != (const LimbVector& lhs, const LimbVector& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    limb* _data;
+    size_t _size;
+    size_t _capacity;
+    limb _inline[N];
+
+    // A heap buffer is preceded by one limb that holds the resource it came from
+    BIGINTEGER_NOINLINE static limb* allocate(size_t count) {
+        std::pmr::memory_resource* resource = BigIntegerMemoryScope::current();
+        void* block = resource ? resource->allocate((count + 1) * sizeof(limb), alignof(limb))
+                               : std::malloc((count + 1) * sizeof(limb));
+        if (!block) {
+            throw std::bad_alloc();
+        }
+        std::memcpy(block, &resource, sizeof(resource));
+        return static_cast<limb*>(block) + 1;
+    }
+    BIGINTEGER_NOINLINE static void deallocate(limb* data, size_t count) {
+        limb* block = data - 1;
+        std::pmr::memory_resource* resource;
+        std::memcpy(&resource, block, sizeof(resource));
+        if (resource) {
+            resource->deallocate(block, (count + 1) * sizeof(limb), alignof(limb));
+        }
+        else {
+            std::free(block);
+        }
+    }
+    void release() {
+        if (_data != _inline) {
+            deallocate(_data, _capacity);
+        }
+    }
+    // Geometric growth so that repeated push_back stays amortized O(1)
+    void grow(size_t count) {
+        if (count > _capacity) {
+            reserve(std::max(count, 2 * _capacity));
+        }
+    }
+    // Takes other's heap block or copies its inline limbs, leaving other empty and inline; *this must be inline
+    void steal(LimbVector& other) {
+        if (other._data != other._inline) {
+            _data = other._data;
+            _capacity = other._capacity;
+            other._data = other._inline;
+            other._capacity = N;
+        }
+        else {
+            std::copy(other._inline, other._inline + other._size, _inline);
+        }
+        _size = other._size;
+        other._size = 0;
+    }
+    // Shifts the tail right to leave count uninitialized slots at pos, returns their index
+    size_t open(const_iterator pos, size_t count) {
+        size_t at = pos - _data;
+        grow(_size + count);
+        std::copy_backward(_data + at, _data + _size, _data + _size + count);
+        _size += count;
+        return at;
+    }
+};
+
+typedef LimbVector<BIGINTEGER_INLINE_LIMBS> limb_vector;
+
+// Work-stealing fork-join pool for BigInteger::setThreadPool. Every worker owns a deque: it forks
+// onto the back and takes its own work back from there, idle workers steal from the front of the
+// others'. Threads outside the pool fork onto one shared extra deque. A thread waiting for a
+// forked task runs other tasks meanwhile, so nested joins neither block a worker nor deadlock.
+class BigIntegerThreadPool {
+public:
+    explicit BigIntegerThreadPool(size_t threads = std::max(std::thread::hardware_concurrency(), 1u));
+    ~BigIntegerThreadPool();
+    BigIntegerThreadPool(const BigIntegerThreadPool&) = delete;
+    BigIntegerThreadPool& operator = (const BigIntegerThreadPool&) = delete;
+    size_t size() const {return _threads;}
+
+    // Runs first here and second wherever a thread is free, and returns once both are done
+    template <class First, class Second>
+    void join(First&& first, Second&& second) {
+        Task task(&runCallable<typename std::remove_reference<Second>::type>, &second);
+        size_t index = queueIndex();
+        push(index, &task);
+        std::exception_ptr error;
+        try {
+            first();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        if (take(index, &task)) {
+            run(&task);
+        }
+        while (!task.done.load(std::memory_order_acquire)) {
+            if (!runOther(index)) {
+                std::this_thread::yield();
+            }
+        }
+        if (error || (error = task.error)) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    // body(i) for every i in [begin, end), split in halves down to single indices
+    template <class Body>
+    void parallelFor(size_t begin, size_t end, const Body& body) {
+        if (end - begin <= 1) {
+            if (begin < end) {
+                body(begin);
+            }
+            return;
+        }
+        size_t middle = begin + (end - begin) / 2;
+        join([&]() {parallelFor(begin, middle, body);}, [&]() {parallelFor(middle, end, body);});
+    }
+
+private:
+    struct Task {
+        void (*call)(void*);
+        void* callable;
+        std::atomic<bool> done;
+        std::exception_ptr error;
+        Task(void (*new_call)(void*), void* new_callable) : call(new_call), callable(new_callable), done(false) {}
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task*> tasks;
+    };
+
+    template <class Callable>
+    static void runCallable(void* callable) {(*static_cast<Callable*>(callable))();}
+
+    size_t queueIndex() const;
+    void push(size_t index, Task* task);
+    bool take(size_t index, Task* task);
+    bool runOther(size_t index);
+    static void run(Task* task);
+    void workerLoop(size_t index);
+
+    // Fixed before any worker starts, unlike _workers.size()
+    const size_t _threads;
+    std::vector<std::thread> _workers;
+    // One deque per worker and the shared one for outside threads last
+    std::unique_ptr<Queue[]> _queues;
+    std::atomic<size_t> _queued;
+    bool _stop;
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake;
+    // The pool the current thread works for and its deque there
+    static thread_local const BigIntegerThreadPool* _current_pool;
+    static thread_local size_t _current_index;
+};
 
 enum Sign {
     NEGATIVE = -1,
@@ -10,24 +413,71 @@ enum Sign {
     POSITIVE = 1
 };
 
+// Layouts for BigInteger::toBytes and fromBytes
+enum class ByteOrder {
+    LITTLE,
+    BIG
+};
+
+enum class SignEncoding {
+    // Negatives as 2^(8 * size) - |num|, the top bit of the most significant byte is the sign
+    TWOS_COMPLEMENT,
+    // The magnitude, with the top bit of the most significant byte set for negatives
+    SIGN_MAGNITUDE
+};
+
 static Sign operator!(Sign sign) {
     return sign == ZERO ? ZERO : sign == POSITIVE ? NEGATIVE : POSITIVE;
 }
 
+template <class Expr>
+class BigIntegerExpr;
+class BigIntegerTerms;
+template <size_t Bits>
+class FixedBigInt;
+class Rational;
+class RationalMatrix;
+
 class BigInteger {
 public:
-    BigInteger(): _sign(ZERO),_bits(1,0), size(1) {}
+    BigInteger(): _sign(ZERO),_bits(1,0) {}
     BigInteger(const int& num);
     BigInteger(const BigInteger& num);
-    explicit BigInteger(const std::string& str_num);
+    // Moves steal the limb buffer and leave zero behind
+    BigInteger(BigInteger&& num) noexcept;
+    explicit BigInteger(std::string_view str_num);
     explicit operator bool() {return _sign != ZERO;}
     BigInteger& operator = (const BigInteger& other);
+    BigInteger& operator = (BigInteger&& other) noexcept;
+    // Evaluates a lazy(...) expression, see EXPRESSION_TEMPLATES
+    template <class Expr>
+    BigInteger(const BigIntegerExpr<Expr>& expr);
+    template <class Expr>
+    BigInteger& operator = (const BigIntegerExpr<Expr>& expr);
+    // Exact, as every FixedBigInt value is a BigInteger
+    template <size_t Bits>
+    BigInteger(const FixedBigInt<Bits>& num);
     std::string toString() const;
+    // Lowercase hex digits after a '-' for negatives, no prefix
+    std::string toHex() const;
+    // Takes an optional '-', an optional 0x or 0X, then hex digits of either case
+    static BigInteger fromHex(std::string_view str);
+    // Smallest size toBytes can write the number in, at least one byte
+    size_t byteLength(SignEncoding encoding = SignEncoding::TWOS_COMPLEMENT) const;
+    // Writes the number into out[0, size), sign- or zero-extended to fill it, and returns byteLength(encoding).
+    // If that is more than size nothing is written.
+    size_t toBytes(unsigned char* out, size_t size, ByteOrder order = ByteOrder::LITTLE,
+                   SignEncoding encoding = SignEncoding::TWOS_COMPLEMENT) const;
+    std::vector<unsigned char> toBytes(ByteOrder order = ByteOrder::LITTLE,
+                                       SignEncoding encoding = SignEncoding::TWOS_COMPLEMENT) const;
+    static BigInteger fromBytes(const unsigned char* data, size_t size, ByteOrder order = ByteOrder::LITTLE,
+                                SignEncoding encoding = SignEncoding::TWOS_COMPLEMENT);
 
     //Arithmetic operators
     BigInteger& operator += (const BigInteger& rhs);
     BigInteger& operator -= (const BigInteger& rhs);
-    BigInteger operator - () const;
+    BigInteger operator - () const &;
+    BigInteger operator - () &&;
     BigInteger& operator ++ ();
     BigInteger operator ++ (int);
     BigInteger& operator -- ();
@@ -36,13 +486,37 @@ public:
     BigInteger& operator *= (const int& rhs);
     BigInteger& operator /= (const BigInteger& rhs);
     BigInteger& operator %= (const BigInteger& rhs);
+    // *this becomes the quotient, remainder gets what is left
+    BigInteger& divmod(const BigInteger& divisor, BigInteger& remainder);
     friend BigInteger operator * (const BigInteger& lhs, const BigInteger& rhs);
     friend BigInteger operator / (const BigInteger& lhs, const BigInteger& rhs);
     friend BigInteger operator % (const BigInteger& lhs, const BigInteger& rhs);
     friend BigInteger& operator += (BigInteger& lhs, const int& rhs);
     friend BigInteger& operator -= (BigInteger& lhs, const int& rhs);
     friend BigInteger operator + (BigInteger lhs, const BigInteger& rhs);
+    friend BigInteger operator + (const BigInteger& lhs, BigInteger&& rhs);
     friend BigInteger operator - (BigInteger lhs, const BigInteger& rhs);
+    friend BigInteger operator - (const BigInteger& lhs, BigInteger&& rhs);
+    // Truncating division: the quotient rounds toward zero, the remainder takes the dividend's sign
+    static void divmod(const BigInteger& dividend, const BigInteger& divisor,
+                       BigInteger& quotient, BigInteger& remainder);
+    friend std::pair<BigInteger, BigInteger> divmod(const BigInteger& dividend, const BigInteger& divisor);
+    // dividend / divisor for a divisor known to divide dividend; anything else gives a meaningless result
+    friend BigInteger divExact(const BigInteger& dividend, const BigInteger& divisor);
+
+    //Bitwise operators, as if on the infinite two's complement form: ~x == -x - 1 and x >> k rounds
+    //toward minus infinity
+    BigInteger& operator <<= (size_t shift);
+    BigInteger& operator >>= (size_t shift);
+    BigInteger& operator &= (const BigInteger& rhs);
+    BigInteger& operator |= (const BigInteger& rhs);
+    BigInteger& operator ^= (const BigInteger& rhs);
+    BigInteger operator ~ () const;
+    friend BigInteger operator << (BigInteger lhs, size_t shift);
+    friend BigInteger operator >> (BigInteger lhs, size_t shift);
+    friend BigInteger operator & (const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator | (const BigInteger& lhs, const BigInteger& rhs);
+    friend BigInteger operator ^ (const BigInteger& lhs, const BigInteger& rhs);
 
     //Relations operators
     friend bool operator == (const BigInteger& lhs, const BigInteger& rhs);
@@ -53,144 +527,409 @@ public:
     friend bool operator >= (const BigInteger& lhs, const BigInteger& rhs);
     friend std::istream& operator >> (std::istream& stream, BigInteger& num);
     friend std::ostream& operator << (std::ostream& stream, const BigInteger& num);
-    
+
     // Auxiliary functions
     void Negate();
     friend BigInteger abs(const BigInteger& num);
+    friend BigInteger abs(BigInteger&& num);
+    friend BigInteger sqr(const BigInteger& num);
+    friend BigInteger pow(const BigInteger& base, uint64_t exp);
+    // base^exp reduced into [0, |mod|); exp must be nonnegative
+    friend BigInteger powmod(const BigInteger& base, const BigInteger& exp, const BigInteger& mod);
+    // floor(sqrt(num)) for num >= 0
+    friend BigInteger isqrt(const BigInteger& num);
+    // The k-th root rounded toward zero, k >= 1; even k need num >= 0
+    friend BigInteger iroot(const BigInteger& num, unsigned k);
+    friend BigInteger GreatestCommonDivisor(BigInteger a, BigInteger b);
+    // Returns g = gcd(a, b) >= 0 and sets x, y so that a * x + b * y = g
+    friend BigInteger ExtendedGreatestCommonDivisor(const BigInteger& a, const BigInteger& b,
+                                                    BigInteger& x, BigInteger& y);
+    static void setMulThresholds(size_t karatsuba, size_t toom3, size_t toom4, size_t ntt);
+    // Forks the top levels of multiplication, and of the division and conversion built on it, onto pool
+    // for operands of at least min_limbs limbs; nullptr, the default, keeps everything on the calling thread.
+    // The pool must outlive its use and should not be swapped while other threads compute.
+    static void setThreadPool(BigIntegerThreadPool* pool, size_t min_limbs = 2048);
 
 private:
-    static const int _mod = 9;
-    static const int _base = 1000000000;
+    friend class BigIntegerTerms;
+    template <size_t Bits>
+    friend class FixedBigInt;
+    friend class BigIntegerBatch;
+    friend class Rational;
+    friend class RationalMatrix;
+
+    // Limbs are binary: _bits holds the magnitude in base 2^64, lowest limb first.
+    // Decimal is only used on the way in and out, in groups of _dec_digits digits.
+    static constexpr int _dec_digits = 19;
+    static constexpr limb _dec_base = 10000000000000000000ULL;
+    // Below this many limbs decimal conversion is done limb by limb, above it by divide and conquer.
+    static constexpr size_t _dec_dc_threshold = 32;
+    // Multiplication tiers by operand size in limbs: schoolbook below _karatsuba_threshold,
+    // then Karatsuba, Toom-3, Toom-4 and finally the three-prime NTT; see setMulThresholds
+    static size_t _karatsuba_threshold;
+    static size_t _toom3_threshold;
+    static size_t _toom4_threshold;
+    static size_t _ntt_threshold;
+    // Divisors of at least this many limbs are divided through a Newton reciprocal, shorter ones by Knuth's algorithm D.
+    // Building the reciprocal costs a few n-limb products however short the quotient, so quotients also need
+    // max(_newton_threshold, n / 10) limbs: the measured crossover against algorithm D's O(n * q) is about 2500
+    // quotient limbs for 4000-limb divisors, 3500 for 16000 and 6500 for 64000.
+    static constexpr size_t _newton_threshold = 4000;
+    // Limb arrays shorter than this skip the SIMD kernels, whose setup would outweigh the work
+    static constexpr size_t _simd_min_limbs = 16;
+    // GCD reductions by fewer limbs than this run Lehmer steps, longer ones split in half-GCD fashion
+    static constexpr size_t _hgcd_threshold = 16;
+    static BigIntegerThreadPool* _thread_pool;
+    static size_t _parallel_threshold;
     Sign _sign;
-    std::vector<int> _bits;
-    size_t size;
+    limb_vector _bits;
+
+    // One of the three NTT primes c * 2^46 + 1 with Montgomery arithmetic modulo it
+    struct NttPrime {
+        limb mod;
+        limb neg_inv;
+        limb r2;
+        limb root;
+        NttPrime(limb new_mod, limb new_root);
+        limb mul(limb lhs, limb rhs) const;
+        limb pow(limb base, limb exp) const;
+        limb toMont(limb num) const {return mul(num % mod, r2);}
+        limb fromMont(limb num) const {return mul(num, 1);}
+    };
 
-    void shiftRight();
+    struct GcdMatrix;
+
+    typedef limb (*CarryKernel)(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    typedef int (*CompareKernel)(const limb* lhs, const limb* rhs, size_t n);
+    // Add, subtract and compare over equal-length arrays, picked once for the running CPU
+    static CarryKernel _add_kernel;
+    static CarryKernel _sub_kernel;
+    static CompareKernel _cmp_kernel;
+
+    BigInteger(limb_vector bits, Sign sign);
     void rmInsignNulls();
-    void sumVec(std::vector<int>& lhs, const std::vector<int>& rhs);
-    std::vector<int> karatsuba(std::vector<int>& A, std::vector<int>& B);
-    std::vector<int> simpleMultiply(const std::vector<int>& A, const std::vector<int>& B);
+    void addSigned(const limb_vector& rhs, Sign rhs_sign);
+    void addSmall(limb value, Sign value_sign);
+    static void trimVec(limb_vector& vec);
+    static int cmpVec(const limb_vector& lhs, const limb_vector& rhs);
+    static void sumVec(limb_vector& lhs, const limb_vector& rhs);
+    static void subVec(limb_vector& lhs, const limb_vector& rhs);
+    static void mulSmall(limb_vector& vec, limb mul, limb add = 0);
+    static limb divSmall(limb_vector& vec, limb div);
+    static void divKnuth(const limb* A, size_t a_size, const limb* B, size_t b_size,
+                         limb* quotient, limb* remainder);
+    static void divNewton(const limb_vector& A, const limb_vector& B,
+                          limb_vector& quotient, limb_vector& remainder, const limb_vector* inverse = nullptr);
+    static limb_vector reciprocal(const limb_vector& B);
+    static limb_vector normalizedReciprocal(const limb_vector& B);
+    template <class Op>
+    static BigInteger bitwise(const BigInteger& lhs, const BigInteger& rhs, Op op);
+    static void shiftBitsLeft(limb_vector& vec, int shift);
+    static void shiftBitsRight(limb_vector& vec, int shift);
+    static void shiftLeft(limb_vector& vec, size_t bits);
+    static void shiftRight(limb_vector& vec, size_t bits);
+    static size_t bitLength(const limb_vector& vec);
+    static BigInteger rootMagnitude(const BigInteger& num, unsigned k);
+    static limb_vector mulAddSmall(const limb_vector& u, limb x, const limb_vector& v, limb y);
+    static limb_vector mulSubSmall(const limb_vector& u, limb x, const limb_vector& v, limb y);
+    static void hgcdReduce(BigInteger& a, BigInteger& b, size_t stop, GcdMatrix* matrix);
+    static bool lehmerStep(BigInteger& a, BigInteger& b, GcdMatrix* matrix);
+    static void divisionStep(BigInteger& a, BigInteger& b, GcdMatrix* matrix);
+    static bool applyMatrix(BigInteger& a, BigInteger& b, const GcdMatrix& step);
+    static void divModVec(const limb_vector& A, const limb_vector& B,
+                          limb_vector& quotient, limb_vector& remainder);
+    static limb_vector sqrVec(const limb_vector& A);
+    static void karatsubaSquare(limb* result, const limb* A, size_t n, limb* scratch);
+    static void simpleSquare(limb* result, const limb* A, size_t n);
+    static size_t windowSize(size_t bits);
+    template <class Square, class Multiply>
+    static limb_vector slidingWindowPow(const limb_vector& base, const limb_vector& exp, Square square, Multiply multiply);
+    static void montgomeryReduce(limb_vector& T, const limb_vector& mod, limb neg_inv);
+    static bool parallel(size_t limbs);
+    template <class Body>
+    static void forkEach(size_t limbs, size_t count, const Body& body);
+    static limb_vector mulVec(const limb_vector& A, const limb_vector& B);
+    static limb_vector mulUnbalanced(const limb_vector& A, const limb_vector& B);
+    static void karatsuba(limb* result, const limb* A, const limb* B, size_t n, limb* scratch);
+    static size_t karatsubaScratch(size_t n);
+    static limb_vector toomCook(const limb_vector& A, const limb_vector& B, size_t k);
+    static limb_vector nttMultiply(const limb_vector& A, const limb_vector& B);
+    static void ntt(limb_vector& values, bool invert, const NttPrime& prime);
+    static void simpleMultiply(limb* result, const limb* A, size_t a_size, const limb* B, size_t b_size);
+    static limb addN(limb* result, const limb* lhs, const limb* rhs, size_t n);
+    static limb subN(limb* result, const limb* lhs, const limb* rhs, size_t n);
+    static int cmpN(const limb* lhs, const limb* rhs, size_t n);
+    static limb addScalar(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    static limb subScalar(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    static int cmpScalar(const limb* lhs, const limb* rhs, size_t n);
+#ifdef BIGINTEGER_X86_SIMD
+    static limb addAvx2(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    static limb subAvx2(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    static int cmpAvx2(const limb* lhs, const limb* rhs, size_t n);
+    static limb addSse42(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    static limb subSse42(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe);
+    static int cmpSse42(const limb* lhs, const limb* rhs, size_t n);
+#endif
+    static int simdLevel();
+    static limb addTo(limb* lhs, size_t lhs_size, const limb* rhs, size_t rhs_size);
+    static limb subFrom(limb* lhs, size_t lhs_size, const limb* rhs, size_t rhs_size);
+    static limb mulAddRow(limb* result, const limb* A, size_t n, limb mul);
+    static limb mulSubRow(limb* result, const limb* A, size_t n, limb mul);
+    static bool absDiff(limb* result, const limb* lhs, size_t lhs_size, const limb* rhs, size_t rhs_size);
+    static limb_vector parseDecimal(std::string_view str);
+    static limb_vector parseRange(std::string_view str, const std::vector<limb_vector>& powers, size_t level);
+    static limb_vector parseSmall(std::string_view str);
+    static limb parseEight(const char* str);
+    static std::vector<limb_vector> decimalPowers(size_t limbs);
+    static void printDecimal(std::string& out, const limb_vector& A, const std::vector<limb_vector>& powers,
+                             const std::vector<limb_vector>& inverses, size_t level, size_t width);
+    static void printSmall(std::string& out, limb_vector A, size_t width);
+    static void printGroup(char* out, limb group, size_t digits);
+    static void storeLimb(unsigned char* out, size_t size, size_t i, limb value, ByteOrder order);
+    static limb loadLimb(const unsigned char* data, size_t size, size_t i, ByteOrder order, limb fill);
+    static limb hexDigit(char c);
+};
+
+// Euclid steps collected so far: (a_in; b_in) = M (a; b) with M = (m[0] m[1]; m[2] m[3]),
+// entries >= 0 and det = +-1
+struct BigInteger::GcdMatrix {
+    BigInteger m[4];
+    int det;
+    GcdMatrix();
+    bool isIdentity() const;
+    void multiply(const GcdMatrix& rhs);
+    void multiplySmall(limb n00, limb n01, limb n10, limb n11, int rhs_det);
 };
 
+size_t BigInteger::_karatsuba_threshold = 32;
+size_t BigInteger::_toom3_threshold = 700;
+size_t BigInteger::_toom4_threshold = 2500;
+size_t BigInteger::_ntt_threshold = 30000;
+BigIntegerThreadPool* BigInteger::_thread_pool = nullptr;
+size_t BigInteger::_parallel_threshold = 2048;
+thread_local const BigIntegerThreadPool* BigIntegerThreadPool::_current_pool = nullptr;
+thread_local size_t BigIntegerThreadPool::_current_index = 0;
+
+#ifdef BIGINTEGER_X86_SIMD
+BigInteger::CarryKernel BigInteger::_add_kernel = simdLevel() == 2 ? &BigInteger::addAvx2
+                                                : simdLevel() == 1 ? &BigInteger::addSse42 : &BigInteger::addScalar;
+BigInteger::CarryKernel BigInteger::_sub_kernel = simdLevel() == 2 ? &BigInteger::subAvx2
+                                                : simdLevel() == 1 ? &BigInteger::subSse42 : &BigInteger::subScalar;
+BigInteger::CompareKernel BigInteger::_cmp_kernel = simdLevel() == 2 ? &BigInteger::cmpAvx2
+                                                  : simdLevel() == 1 ? &BigInteger::cmpSse42 : &BigInteger::cmpScalar;
+#else
+BigInteger::CarryKernel BigInteger::_add_kernel = &BigInteger::addScalar;
+BigInteger::CarryKernel BigInteger::_sub_kernel = &BigInteger::subScalar;
+BigInteger::CompareKernel BigInteger::_cmp_kernel = &BigInteger::cmpScalar;
+#endif
+
+// _____________________________________THREAD_POOL_____________________________________
+BigIntegerThreadPool::BigIntegerThreadPool(size_t threads) : _threads(threads),
+                                                             _queues(new Queue[threads + 1]),
+                                                             _queued(0),
+                                                             _stop(false) {
+    for (size_t i = 0; i < threads; ++i) {
+        _workers.emplace_back(&BigIntegerThreadPool::workerLoop, this, i);
+    }
+}
+
+BigIntegerThreadPool::~BigIntegerThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+size_t BigIntegerThreadPool::queueIndex() const {
+    return _current_pool == this ? _current_index : _threads;
+}
+
+void BigIntegerThreadPool::push(size_t index, Task* task) {
+    {
+        std::lock_guard<std::mutex> lock(_queues[index].mutex);
+        _queues[index].tasks.push_back(task);
+    }
+    _queued.fetch_add(1);
+    // Taking the lock orders the count before any worker's check of it, so no wakeup is lost
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _wake.notify_one();
+}
+
+// Takes task back from the deque it went to, unless another thread has taken it already
+bool BigIntegerThreadPool::take(size_t index, Task* task) {
+    Queue& queue = _queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    auto it = std::find(queue.tasks.rbegin(), queue.tasks.rend(), task);
+    if (it == queue.tasks.rend()) {
+        return false;
+    }
+    queue.tasks.erase(std::next(it).base());
+    _queued.fetch_sub(1);
+    return true;
+}
+
+// Runs the newest task of deque index or else the oldest of the first other one that has any;
+// false if every deque was empty
+bool BigIntegerThreadPool::runOther(size_t index) {
+    size_t count = _threads + 1;
+    for (size_t k = 0; k < count; ++k) {
+        Queue& queue = _queues[(index + k) % count];
+        Task* task;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            if (k == 0) {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+            else {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+        }
+        _queued.fetch_sub(1);
+        run(task);
+        return true;
+    }
+    return false;
+}
+
+// The owner may free task as soon as it is marked done, so that comes last
+void BigIntegerThreadPool::run(Task* task) {
+    try {
+        task->call(task->callable);
+    }
+    catch (...) {
+        task->error = std::current_exception();
+    }
+    task->done.store(true, std::memory_order_release);
+}
+
+void BigIntegerThreadPool::workerLoop(size_t index) {
+    _current_pool = this;
+    _current_index = index;
+    while (true) {
+        if (runOther(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _wake.wait(lock, [this]() {return _stop || _queued.load() > 0;});
+        if (_stop) {
+            return;
+        }
+    }
+}
+
+bool BigInteger::parallel(size_t limbs) {
+    return _thread_pool != nullptr && limbs >= _parallel_threshold;
+}
+
+// body(i) for i in [0, count), spread over the pool if the work spans enough limbs
+template <class Body>
+void BigInteger::forkEach(size_t limbs, size_t count, const Body& body) {
+    if (parallel(limbs) && count > 1) {
+        _thread_pool->parallelFor(0, count, body);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        body(i);
+    }
+}
+
 // _____________________________________CONSTRUCTORS_____________________________________
 BigInteger::BigInteger(const int& num) {
     if (num == 0) {
         _sign = ZERO;
         _bits.push_back(0);
-        size = 1;
         return;
     }
     _sign = num > 0 ? POSITIVE : NEGATIVE;
-    _bits.push_back(abs(num) % _base);
-        size = 1;
-    if (abs(num) / _base) {
-        _bits.push_back(abs(num) / _base);
-        ++size;
-    }
+    _bits.push_back(num > 0 ? static_cast<limb>(num) : 0 - static_cast<limb>(num));
 }
 
 BigInteger::BigInteger(const BigInteger& num) : _sign(num._sign),
-                                                _bits(num._bits),
-                                                size(num.size) {}
+                                                _bits(num._bits) {}
+
+BigInteger::BigInteger(BigInteger&& num) noexcept : _sign(num._sign),
+                                                    _bits(std::move(num._bits)) {
+    num._sign = ZERO;
+    num._bits.assign(1, 0);
+}
+
+BigInteger::BigInteger(limb_vector bits, Sign sign) : _sign(sign),
+                                                            _bits(std::move(bits)) {
+    rmInsignNulls();
+    if (_bits.size() == 1 && _bits[0] == 0) {
+        _sign = ZERO;
+    }
+}
 
-BigInteger::BigInteger(const std::string& str) {
-    std::string str_num(str);
-    if (*str_num.begin() == '-') {
+BigInteger::BigInteger(std::string_view str) {
+    if (!str.empty() && str[0] == '-') {
         _sign = NEGATIVE;
-        str_num.erase(str_num.begin());
+        str.remove_prefix(1);
     }
     else {
         _sign = POSITIVE;
     }
-    if (str_num == "0") {
+    _bits = parseDecimal(str);
+    if (_bits.size() == 1 && _bits[0] == 0) {
         _sign = ZERO;
-        _bits.push_back(0);
-        size = 1;
-        return;
-    }
-    for (int pos = static_cast<int>(str_num.size()); pos > 0; pos -= BigInteger::_mod) {
-        if (pos < BigInteger::_mod) {
-            _bits.push_back(stoi(str_num.substr(0, pos)));
-        }
-        else {
-            _bits.push_back(stoi(str_num.substr(pos - BigInteger::_mod, BigInteger::_mod)));
-        }
     }
-    size = _bits.size();
 }
 
 // _____________________________________ASSIGHMENTS_OPERATORS_____________________________________
 BigInteger& BigInteger::operator = (const BigInteger& other) {
-    if (*this != other) {
-        _bits.resize(other.size);
-        size = other.size;
-        std::copy(other._bits.begin(), other._bits.end(), _bits.begin());
+    if (this != &other) {
+        _bits = other._bits;
         _sign = other._sign;
     }
     return *this;
 }
 
+// Swapping hands our old buffer to other, so it stays a valid number and frees it in its own time
+BigInteger& BigInteger::operator = (BigInteger&& other) noexcept {
+    _bits.swap(other._bits);
+    std::swap(_sign, other._sign);
+    return *this;
+}
+
 // _____________________________________ARITHMETIC_OPERATORS_____________________________________
 void BigInteger::Negate() {
     _sign = !_sign;
 }
 
 BigInteger& BigInteger::operator += (const BigInteger& rhs) {
-    if (_sign == rhs._sign){
-        sumVec(_bits, rhs._bits);
-    }
-    else {
-        int cashe = 0;
-        if (abs(*this) > abs(rhs)) {
-            for (size_t i = 0; i < size || cashe; ++i) {
-                _bits[i] -= cashe + (i >= rhs.size ? 0 : rhs._bits[i]);
-                if (_bits[i] < 0) {
-                    cashe = 1;
-                    _bits[i] += _base;
-                }
-                else {
-                    cashe = 0;
-                }
-            }
-        }
-        else {
-            _sign = rhs._sign;
-            _bits.resize(rhs.size, 0);
-            for (size_t i = 0; i < rhs.size || cashe; ++i) {
-                _bits[i] = rhs._bits[i] - (cashe + _bits[i]);
-                if (_bits[i] < 0) {
-                    cashe = 1;
-                    _bits[i] += _base;
-                }
-                else {
-                    cashe = 0;
-                }
-            }
-        }
-        rmInsignNulls();
-        size = _bits.size();
-        if (size == 1 && _bits[0] == 0) {
-            _sign = ZERO;
-        }
-    }
+    addSigned(rhs._bits, rhs._sign);
     return *this;
 }
 
 BigInteger& BigInteger::operator -= (const BigInteger& rhs) {
-        _sign = !_sign;
-        *this += rhs;
-        _sign = !_sign;
+    addSigned(rhs._bits, !rhs._sign);
     return *this;
 }
 
-BigInteger BigInteger::operator - () const {
+BigInteger BigInteger::operator - () const & {
     BigInteger new_num(*this);
     new_num.Negate();
     return new_num;
 }
 
+BigInteger BigInteger::operator - () && {
+    Negate();
+    return std::move(*this);
+}
+
 BigInteger& BigInteger::operator ++ () {
-    *this += 1;
+    addSmall(1, POSITIVE);
     return *this;
 }
 
@@ -201,7 +940,7 @@ BigInteger BigInteger::operator ++ (int) {
 }
 
 BigInteger& BigInteger::operator -- () {
-    *this -= 1;
+    addSmall(1, NEGATIVE);
     return *this;
 }
 
@@ -214,69 +953,41 @@ BigInteger BigInteger::operator -- (int) {
 BigInteger& BigInteger::operator *= (const BigInteger& rhs) {
     if (_sign == ZERO || rhs._sign == ZERO) {
         _sign = ZERO;
-        size = 1;
-        _bits.resize(size);
+        _bits.resize(1);
         _bits[0] = 0;
         return *this;
     }
-    size = std::max(size, rhs.size);
-    std::vector<int> rhs_copy = rhs._bits;
-    rhs_copy.resize(size, 0);
-    _bits.resize(size, 0);
     _sign = _sign == rhs._sign ? POSITIVE : NEGATIVE;
-    
-    _bits = karatsuba(_bits, rhs_copy);
-    
+
+    _bits = mulVec(_bits, rhs._bits);
+
     rmInsignNulls();
-    
+
     return *this;
 }
 
 BigInteger& BigInteger::operator *= (const int& rhs) {
-    BigInteger num(rhs);
-    operator *= (num);
+    if (_sign == ZERO || rhs == 0) {
+        return *this = BigInteger();
+    }
+    if (rhs < 0) {
+        _sign = !_sign;
+    }
+    mulSmall(_bits, rhs > 0 ? static_cast<limb>(rhs) : 0 - static_cast<limb>(rhs));
     return *this;
 }
 
 BigInteger& BigInteger::operator /= (const BigInteger& rhs) {
     if (_sign == ZERO) {
-        _sign = ZERO;
-        size = 1;
-        _bits.resize(size);
-        _bits[0] = 0;
         return *this;
     }
     _sign = _sign == rhs._sign ? POSITIVE : NEGATIVE;
-    BigInteger main_divisor(rhs);
-    main_divisor._sign = POSITIVE;
-    BigInteger current_dividend;
-    current_dividend._bits.pop_back();
-    current_dividend.size = 0;
-    current_dividend._sign = POSITIVE;
-    BigInteger tmp;
-    for (ll i = static_cast<ll>(_bits.size()) - 1; i >=0; --i) {
-        current_dividend.shiftRight();
-        current_dividend._bits[0] = _bits[i];
-        current_dividend.rmInsignNulls();
-        int divider = 0, left_divider = 0, right_divider = _base;
-        while (left_divider <= right_divider) {
-            int cur_divider = (left_divider + right_divider) / 2;
-            tmp = main_divisor * cur_divider;
-            current_dividend._sign = POSITIVE;
-            if (tmp <= current_dividend) {
-                divider = cur_divider;
-                left_divider = cur_divider + 1;
-            }
-            else {
-                right_divider = cur_divider - 1;
-            }
-            
-        }
-        _bits[i] = divider;
-        current_dividend -= main_divisor * divider;
-    }
+    limb_vector quotient;
+    limb_vector remainder;
+    divModVec(_bits, rhs._bits, quotient, remainder);
+    _bits.swap(quotient);
     rmInsignNulls();
-    
+
     if (_bits.size() == 1 && _bits.back() == 0) {
         _sign = ZERO;
     }
@@ -284,268 +995,2987 @@ BigInteger& BigInteger::operator /= (const BigInteger& rhs) {
 }
 
 BigInteger& BigInteger::operator %= (const BigInteger& rhs) {
-    *this = *this - (*this / rhs) * rhs;
+    if (_sign == ZERO) {
+        return *this;
+    }
+    limb_vector quotient;
+    limb_vector remainder;
+    divModVec(_bits, rhs._bits, quotient, remainder);
+    _bits.swap(remainder);
+    rmInsignNulls();
+
+    if (_bits.size() == 1 && _bits.back() == 0) {
+        _sign = ZERO;
+    }
+    return *this;
+}
+
+BigInteger& BigInteger::divmod(const BigInteger& divisor, BigInteger& remainder) {
+    divmod(*this, divisor, *this, remainder);
     return *this;
 }
 
 BigInteger& operator += (BigInteger& lhs, const int& rhs) {
-    BigInteger num(rhs);
-    lhs += num;
+    limb value = rhs > 0 ? static_cast<limb>(rhs) : 0 - static_cast<limb>(rhs);
+    lhs.addSmall(value, rhs > 0 ? POSITIVE : rhs < 0 ? NEGATIVE : ZERO);
     return lhs;
 }
 
 BigInteger& operator -= (BigInteger& lhs, const int& rhs) {
-    BigInteger num(rhs);
-    lhs -= num;
+    limb value = rhs > 0 ? static_cast<limb>(rhs) : 0 - static_cast<limb>(rhs);
+    lhs.addSmall(value, rhs > 0 ? NEGATIVE : rhs < 0 ? POSITIVE : ZERO);
     return lhs;
 }
 
+// lhs is taken by value so that an expiring left operand lends its buffer to the result
 BigInteger operator + (BigInteger lhs, const BigInteger& rhs) {
-    return lhs += rhs;
+    lhs += rhs;
+    return lhs;
+}
+
+BigInteger operator + (const BigInteger& lhs, BigInteger&& rhs) {
+    rhs += lhs;
+    return std::move(rhs);
 }
 
 BigInteger operator - (BigInteger lhs, const BigInteger& rhs) {
-    return lhs -= rhs;
+    lhs -= rhs;
+    return lhs;
+}
+
+BigInteger operator - (const BigInteger& lhs, BigInteger&& rhs) {
+    rhs -= lhs;
+    rhs.Negate();
+    return std::move(rhs);
 }
 
+// The product and quotient limbs are built in fresh vectors anyway, so copying lhs first would be wasted
 BigInteger operator * (const BigInteger& lhs, const BigInteger& rhs) {
-    BigInteger result(lhs);
-    return result *= rhs;
+    if (lhs._sign == ZERO || rhs._sign == ZERO) {
+        return BigInteger();
+    }
+    return BigInteger(BigInteger::mulVec(lhs._bits, rhs._bits), lhs._sign == rhs._sign ? POSITIVE : NEGATIVE);
 }
 
 BigInteger operator / (const BigInteger& lhs, const BigInteger& rhs) {
-    BigInteger tmp(lhs);
-    return tmp /= rhs;
+    if (lhs._sign == ZERO) {
+        return BigInteger();
+    }
+    limb_vector quotient;
+    limb_vector remainder;
+    BigInteger::divModVec(lhs._bits, rhs._bits, quotient, remainder);
+    return BigInteger(std::move(quotient), lhs._sign == rhs._sign ? POSITIVE : NEGATIVE);
 }
 
 BigInteger operator % (const BigInteger& lhs, const BigInteger& rhs) {
-    BigInteger tmp(lhs);
-    return tmp %= rhs;
+    if (lhs._sign == ZERO) {
+        return BigInteger();
+    }
+    limb_vector quotient;
+    limb_vector remainder;
+    BigInteger::divModVec(lhs._bits, rhs._bits, quotient, remainder);
+    return BigInteger(std::move(remainder), lhs._sign);
 }
 
-// _____________________________________RELATION_OPERATORS_____________________________________
-bool operator == (const BigInteger& lhs, const BigInteger& rhs) {
-    if (lhs._sign != rhs._sign) {
-        return false;
+void BigInteger::divmod(const BigInteger& dividend, const BigInteger& divisor,
+                        BigInteger& quotient, BigInteger& remainder) {
+    limb_vector quotient_bits;
+    limb_vector remainder_bits;
+    divModVec(dividend._bits, divisor._bits, quotient_bits, remainder_bits);
+    Sign quotient_sign = dividend._sign == divisor._sign ? POSITIVE : NEGATIVE;
+    Sign remainder_sign = dividend._sign;
+    quotient = BigInteger(std::move(quotient_bits), quotient_sign);
+    remainder = BigInteger(std::move(remainder_bits), remainder_sign);
+}
+
+std::pair<BigInteger, BigInteger> divmod(const BigInteger& dividend, const BigInteger& divisor) {
+    std::pair<BigInteger, BigInteger> result;
+    BigInteger::divmod(dividend, divisor, result.first, result.second);
+    return result;
+}
+
+// Jebelean's exact division: quotient limbs come from the low end, each one multiplication by
+// divisor^-1 mod 2^64, with no hardware division and none of the dividend's limbs above the quotient's
+// length. For balanced operands that is about half the multiplications of divKnuth.
+BigInteger divExact(const BigInteger& dividend, const BigInteger& divisor) {
+    if (dividend._sign == ZERO || divisor._bits.size() == 1 || divisor._bits.size() >= BigInteger::_newton_threshold) {
+        return dividend / divisor;
+    }
+    limb_vector A = dividend._bits;
+    // The inverse needs an odd divisor, and the dividend has at least as many trailing zeros
+    limb_vector shifted;
+    const limb_vector* odd = &divisor._bits;
+    if ((divisor._bits[0] & 1) == 0) {
+        size_t zeros = 0;
+        while (divisor._bits[zeros] == 0) {
+            ++zeros;
+        }
+        zeros = zeros * 64 + __builtin_ctzll(divisor._bits[zeros]);
+        shifted = divisor._bits;
+        BigInteger::shiftRight(A, zeros);
+        BigInteger::shiftRight(shifted, zeros);
+        odd = &shifted;
+    }
+    const limb_vector& B = *odd;
+    const Sign sign = dividend._sign == divisor._sign ? POSITIVE : NEGATIVE;
+    if (B.size() == 1) {
+        BigInteger::divSmall(A, B[0]);
+        return BigInteger(std::move(A), sign);
+    }
+    if (A.size() < B.size()) {
+        return 0;
+    }
+    const size_t n = A.size() - B.size() + 1;
+    limb inv = B[0];
+    for (int i = 0; i < 6; ++i) {
+        inv *= 2 - B[0] * inv;
+    }
+    limb_vector quotient(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        const limb q = A[i] * inv;
+        quotient[i] = q;
+        const size_t span = std::min(B.size(), n - i);
+        limb cashe = BigInteger::mulSubRow(&A[i], B.data(), span, q);
+        for (size_t j = i + span; cashe != 0 && j < n; ++j) {
+            limb old = A[j];
+            A[j] = old - cashe;
+            cashe = old < cashe;
+        }
+    }
+    return BigInteger(std::move(quotient), sign);
+}
+
+// _____________________________________BITWISE_OPERATORS_____________________________________
+BigInteger& BigInteger::operator <<= (size_t shift) {
+    shiftLeft(_bits, shift);
+    return *this;
+}
+
+// A negative drops one unit further if any of the bits shifted out was set
+BigInteger& BigInteger::operator >>= (size_t shift) {
+    bool inexact = false;
+    if (_sign == NEGATIVE) {
+        size_t whole = std::min(shift / 64, _bits.size());
+        inexact = std::any_of(_bits.begin(), _bits.begin() + whole, [](limb x) { return x != 0; }) ||
+                  (whole < _bits.size() && (_bits[whole] & ((static_cast<limb>(1) << (shift % 64)) - 1)));
+    }
+    shiftRight(_bits, shift);
+    if (_bits.size() == 1 && _bits[0] == 0) {
+        _sign = ZERO;
+    }
+    if (inexact) {
+        addSmall(1, NEGATIVE);
+    }
+    return *this;
+}
+
+BigInteger& BigInteger::operator &= (const BigInteger& rhs) {
+    return *this = *this & rhs;
+}
+
+BigInteger& BigInteger::operator |= (const BigInteger& rhs) {
+    return *this = *this | rhs;
+}
+
+BigInteger& BigInteger::operator ^= (const BigInteger& rhs) {
+    return *this = *this ^ rhs;
+}
+
+BigInteger BigInteger::operator ~ () const {
+    BigInteger result(*this);
+    result.Negate();
+    result.addSmall(1, NEGATIVE);
+    return result;
+}
+
+BigInteger operator << (BigInteger lhs, size_t shift) {
+    lhs <<= shift;
+    return lhs;
+}
+
+BigInteger operator >> (BigInteger lhs, size_t shift) {
+    lhs >>= shift;
+    return lhs;
+}
+
+BigInteger operator & (const BigInteger& lhs, const BigInteger& rhs) {
+    return BigInteger::bitwise(lhs, rhs, [](limb x, limb y) { return x & y; });
+}
+
+BigInteger operator | (const BigInteger& lhs, const BigInteger& rhs) {
+    return BigInteger::bitwise(lhs, rhs, [](limb x, limb y) { return x | y; });
+}
+
+BigInteger operator ^ (const BigInteger& lhs, const BigInteger& rhs) {
+    return BigInteger::bitwise(lhs, rhs, [](limb x, limb y) { return x ^ y; });
+}
+
+// Applies op limb by limb to the two's complement forms. Two nonnegative operands make a plain loop
+// the compiler vectorizes; otherwise negatives are converted on the fly, x -> (x ^ ~0) + carry, and
+// so is a negative result on the way back.
+template <class Op>
+BigInteger BigInteger::bitwise(const BigInteger& lhs, const BigInteger& rhs, Op op) {
+    const limb_vector& A = lhs._bits;
+    const limb_vector& B = rhs._bits;
+    size_t n = std::max(A.size(), B.size());
+    limb lhs_fill = lhs._sign == NEGATIVE ? ~static_cast<limb>(0) : 0;
+    limb rhs_fill = rhs._sign == NEGATIVE ? ~static_cast<limb>(0) : 0;
+    if (!lhs_fill && !rhs_fill) {
+        limb_vector result(n, 0);
+        size_t common = std::min(A.size(), B.size());
+        const limb* a = A.data();
+        const limb* b = B.data();
+        limb* r = result.data();
+        for (size_t i = 0; i < common; ++i) {
+            r[i] = op(a[i], b[i]);
+        }
+        const limb* rest = A.size() > B.size() ? a : b;
+        for (size_t i = common; i < n; ++i) {
+            r[i] = op(rest[i], 0);
+        }
+        return BigInteger(std::move(result), POSITIVE);
+    }
+    // Both operands sign-extended one limb past the longer cover any carry out of the result
+    limb result_fill = op(lhs_fill, rhs_fill);
+    limb_vector result(n + 1, 0);
+    limb lhs_cashe = lhs_fill & 1;
+    limb rhs_cashe = rhs_fill & 1;
+    limb cashe = result_fill & 1;
+    for (size_t i = 0; i <= n; ++i) {
+        limb x = ((i < A.size() ? A[i] : 0) ^ lhs_fill) + lhs_cashe;
+        lhs_cashe &= x == 0;
+        limb y = ((i < B.size() ? B[i] : 0) ^ rhs_fill) + rhs_cashe;
+        rhs_cashe &= y == 0;
+        result[i] = (op(x, y) ^ result_fill) + cashe;
+        cashe &= result[i] == 0;
+    }
+    return BigInteger(std::move(result), result_fill ? NEGATIVE : POSITIVE);
+}
+
+// _____________________________________RELATION_OPERATORS_____________________________________
+bool operator == (const BigInteger& lhs, const BigInteger& rhs) {
+    if (lhs._sign != rhs._sign) {
+        return false;
+    }
+    return lhs._bits == rhs._bits;
+}
+
+bool operator != (const BigInteger& lhs, const BigInteger& rhs) {
+    return !(lhs == rhs);
+}
+
+bool operator < (const BigInteger& lhs, const BigInteger& rhs) {
+    if (lhs._sign != rhs._sign) {
+        return lhs._sign < rhs._sign;
+    }
+    int cmp = BigInteger::cmpVec(lhs._bits, rhs._bits);
+    return lhs._sign == POSITIVE ? cmp < 0 : cmp > 0;
+}
+
+bool operator > (const BigInteger& lhs, const BigInteger& rhs) {
+    return (rhs < lhs);
+}
+
+bool operator <= (const BigInteger& lhs, const BigInteger& rhs) {
+    return !(lhs > rhs);
+}
+
+bool operator >= (const BigInteger& lhs, const BigInteger& rhs) {
+    return !(lhs < rhs);
+}
+
+// _____________________________________STREAM_OPERATORS_____________________________________
+// Both directions switch to hex under std::hex
+std::istream& operator >> (std::istream& stream, BigInteger& num) {
+    std::string s;
+    stream >> s;
+    if ((stream.flags() & std::ios_base::basefield) == std::ios_base::hex) {
+        num = BigInteger::fromHex(s);
+    }
+    else {
+        num = BigInteger(s);
+    }
+    return stream;
+}
+
+std::ostream& operator << (std::ostream& stream, const BigInteger& num) {
+    if ((stream.flags() & std::ios_base::basefield) != std::ios_base::hex) {
+        return stream << num.toString();
+    }
+    std::string s = num.toHex();
+    if (stream.flags() & std::ios_base::uppercase) {
+        std::transform(s.begin(), s.end(), s.begin(), [](char c) { return c >= 'a' ? static_cast<char>(c - 32) : c; });
+    }
+    return stream << s;
+}
+
+// The digits are written into a string reserved for the largest possible length. Large numbers
+// are split by powers 10^(19 * 2^k); each power is divided by many times, so its Newton reciprocal
+// is computed once up front.
+std::string BigInteger::toString() const {
+    std::string s;
+    s.reserve(bitLength(_bits) * 30103 / 100000 + 2);
+    if (_sign == NEGATIVE) {
+        s += '-';
+    }
+    if (_bits.size() <= _dec_dc_threshold) {
+        printSmall(s, _bits, 0);
+        return s;
+    }
+    std::vector<limb_vector> powers = decimalPowers(_bits.size());
+    std::vector<limb_vector> inverses(powers.size());
+    for (size_t i = 0; i < powers.size(); ++i) {
+        if (powers[i].size() >= _newton_threshold) {
+            inverses[i] = normalizedReciprocal(powers[i]);
+        }
+    }
+    printDecimal(s, _bits, powers, inverses, powers.size(), 0);
+    return s;
+}
+
+// _____________________________________BYTES_AND_HEX_____________________________________
+// Limbs are already binary, so these only move bytes: no base conversion, linear time.
+std::string BigInteger::toHex() const {
+    static const char digits[] = "0123456789abcdef";
+    size_t length = std::max<size_t>((bitLength(_bits) + 3) / 4, 1);
+    std::string s(length + (_sign == NEGATIVE), '0');
+    if (_sign == NEGATIVE) {
+        s[0] = '-';
+    }
+    char* end = &s[0] + s.size();
+    for (size_t i = 0; i < length; ++i) {
+        end[-1 - static_cast<ptrdiff_t>(i)] = digits[(_bits[i / 16] >> (4 * (i % 16))) & 15];
+    }
+    return s;
+}
+
+BigInteger BigInteger::fromHex(std::string_view str) {
+    Sign sign = POSITIVE;
+    if (!str.empty() && str[0] == '-') {
+        sign = NEGATIVE;
+        str.remove_prefix(1);
+    }
+    if (str.size() >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        str.remove_prefix(2);
+    }
+    limb_vector bits(std::max<size_t>((str.size() + 15) / 16, 1), 0);
+    for (size_t i = 0; i < str.size(); ++i) {
+        bits[i / 16] |= hexDigit(str[str.size() - 1 - i]) << (4 * (i % 16));
+    }
+    return BigInteger(std::move(bits), sign);
+}
+
+// Two's complement fits -2^k in k + 1 bits but 2^k needs k + 2
+size_t BigInteger::byteLength(SignEncoding encoding) const {
+    size_t bits = bitLength(_bits) + 1;
+    if (_sign == NEGATIVE && encoding == SignEncoding::TWOS_COMPLEMENT) {
+        size_t top = _bits.size() - 1;
+        bool power_of_two = (_bits[top] & (_bits[top] - 1)) == 0 &&
+                            std::all_of(_bits.begin(), _bits.begin() + top, [](limb x) { return x == 0; });
+        bits -= power_of_two;
+    }
+    return (bits + 7) / 8;
+}
+
+// Limb by limb, negating on the fly for two's complement, so no copy of the number is made
+size_t BigInteger::toBytes(unsigned char* out, size_t size, ByteOrder order, SignEncoding encoding) const {
+    size_t length = byteLength(encoding);
+    if (length > size) {
+        return length;
+    }
+    bool complement = _sign == NEGATIVE && encoding == SignEncoding::TWOS_COMPLEMENT;
+    limb cashe = complement;
+    for (size_t i = 0; 8 * i < size; ++i) {
+        limb value = i < _bits.size() ? _bits[i] : 0;
+        if (complement) {
+            value = ~value + cashe;
+            cashe &= value == 0;
+        }
+        storeLimb(out, size, i, value, order);
+    }
+    if (_sign == NEGATIVE && encoding == SignEncoding::SIGN_MAGNITUDE) {
+        out[order == ByteOrder::LITTLE ? size - 1 : 0] |= 0x80;
+    }
+    return length;
+}
+
+std::vector<unsigned char> BigInteger::toBytes(ByteOrder order, SignEncoding encoding) const {
+    std::vector<unsigned char> bytes(byteLength(encoding));
+    toBytes(bytes.data(), bytes.size(), order, encoding);
+    return bytes;
+}
+
+BigInteger BigInteger::fromBytes(const unsigned char* data, size_t size, ByteOrder order, SignEncoding encoding) {
+    if (size == 0) {
+        return BigInteger();
+    }
+    bool negative = data[order == ByteOrder::LITTLE ? size - 1 : 0] & 0x80;
+    bool complement = negative && encoding == SignEncoding::TWOS_COMPLEMENT;
+    limb_vector bits((size + 7) / 8, 0);
+    limb cashe = complement;
+    for (size_t i = 0; i < bits.size(); ++i) {
+        limb value = loadLimb(data, size, i, order, complement ? ~static_cast<limb>(0) : 0);
+        if (complement) {
+            value = ~value + cashe;
+            cashe &= value == 0;
+        }
+        bits[i] = value;
+    }
+    if (negative && encoding == SignEncoding::SIGN_MAGNITUDE) {
+        bits[(size - 1) / 8] &= ~(static_cast<limb>(0x80) << (8 * ((size - 1) % 8)));
+    }
+    return BigInteger(std::move(bits), negative ? NEGATIVE : POSITIVE);
+}
+
+// _____________________________________PRIVATE_METHODS_____________________________________
+void BigInteger::sumVec(limb_vector& lhs, const limb_vector& rhs) {
+    if (lhs.size() < rhs.size()) {
+        lhs.resize(rhs.size(), 0);
+    }
+    if (addTo(lhs.data(), lhs.size(), rhs.data(), rhs.size())) {
+        lhs.push_back(1);
+    }
+}
+
+// *this += rhs_sign * |rhs|. Mixed signs compare the magnitudes in place and subtract the smaller
+// from the larger straight into _bits, which also keeps x -= x and x += x right.
+void BigInteger::addSigned(const limb_vector& rhs, Sign rhs_sign) {
+    if (rhs_sign == ZERO) {
+        return;
+    }
+    if (_sign == rhs_sign) {
+        sumVec(_bits, rhs);
+        return;
+    }
+    if (_sign == ZERO) {
+        _bits = rhs;
+        _sign = rhs_sign;
+        return;
+    }
+    int cmp = cmpVec(_bits, rhs);
+    if (cmp == 0) {
+        _bits.assign(1, 0);
+        _sign = ZERO;
+        return;
+    }
+    if (cmp > 0) {
+        subVec(_bits, rhs);
+    }
+    else {
+        // The subtraction runs limb by limb, so reading and writing _bits in the same pass is fine
+        _bits.resize(rhs.size(), 0);
+        subN(_bits.data(), rhs.data(), _bits.data(), rhs.size());
+        _sign = rhs_sign;
+    }
+    rmInsignNulls();
+}
+
+// *this += value_sign * value without building a BigInteger for the constant
+void BigInteger::addSmall(limb value, Sign value_sign) {
+    if (value_sign == ZERO || value == 0) {
+        return;
+    }
+    if (_sign == ZERO) {
+        _bits[0] = value;
+        _sign = value_sign;
+        return;
+    }
+    if (_sign == value_sign) {
+        for (size_t i = 0; value && i < _bits.size(); ++i) {
+            _bits[i] += value;
+            value = _bits[i] < value;
+        }
+        if (value) {
+            _bits.push_back(1);
+        }
+        return;
+    }
+    if (_bits.size() == 1 && _bits[0] <= value) {
+        _bits[0] = value - _bits[0];
+        _sign = _bits[0] == 0 ? ZERO : value_sign;
+        return;
+    }
+    for (size_t i = 0; value; ++i) {
+        limb old = _bits[i];
+        _bits[i] -= value;
+        value = old < value;
+    }
+    rmInsignNulls();
+}
+
+// lhs -= rhs, the caller guarantees lhs >= rhs
+void BigInteger::subVec(limb_vector& lhs, const limb_vector& rhs) {
+    size_t n = rhs.size();
+    while (n > lhs.size() && rhs[n - 1] == 0) {
+        --n;
+    }
+    subFrom(lhs.data(), lhs.size(), rhs.data(), n);
+}
+
+int BigInteger::cmpVec(const limb_vector& lhs, const limb_vector& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
+    }
+    return cmpN(lhs.data(), rhs.data(), lhs.size());
+}
+
+// vec = vec * mul + add
+void BigInteger::mulSmall(limb_vector& vec, limb mul, limb add) {
+    limb cashe = add;
+    for (size_t i = 0; i < vec.size(); ++i) {
+        dlimb cur = static_cast<dlimb>(vec[i]) * mul + cashe;
+        vec[i] = static_cast<limb>(cur);
+        cashe = static_cast<limb>(cur >> 64);
+    }
+    if (cashe) {
+        vec.push_back(cashe);
+    }
+    trimVec(vec);
+}
+
+// vec /= div, returns the remainder
+limb BigInteger::divSmall(limb_vector& vec, limb div) {
+    limb rem = 0;
+    for (size_t i = vec.size(); i > 0;) {
+        --i;
+        dlimb cur = (static_cast<dlimb>(rem) << 64) | vec[i];
+        vec[i] = static_cast<limb>(cur / div);
+        rem = static_cast<limb>(cur % div);
+    }
+    trimVec(vec);
+    return rem;
+}
+
+void BigInteger::divModVec(const limb_vector& A, const limb_vector& B,
+                           limb_vector& quotient, limb_vector& remainder) {
+    if (cmpVec(A, B) < 0) {
+        quotient.assign(1, 0);
+        remainder = A;
+        return;
+    }
+    if (B.size() == 1) {
+        quotient = A;
+        remainder.assign(1, divSmall(quotient, B[0]));
+        return;
+    }
+    if (B.size() >= _newton_threshold && A.size() - B.size() >= std::max(_newton_threshold, B.size() / 10)) {
+        divNewton(A, B, quotient, remainder);
+        return;
+    }
+    quotient.assign(A.size() - B.size() + 1, 0);
+    remainder.assign(B.size(), 0);
+    divKnuth(A.data(), A.size(), B.data(), B.size(), quotient.data(), remainder.data());
+    trimVec(quotient);
+    trimVec(remainder);
+}
+
+// Knuth's algorithm D for a_size >= b_size >= 2 and B[b_size - 1] != 0. The divisor is shifted
+// so that its top bit is set, then each quotient limb is estimated from the top two limbs of
+// the running remainder and is off by at most one after the usual check against the third.
+void BigInteger::divKnuth(const limb* A, size_t a_size, const limb* B, size_t b_size,
+                          limb* quotient, limb* remainder) {
+    int shift = __builtin_clzll(B[b_size - 1]);
+    limb_vector u(A, A + a_size);
+    limb_vector v(B, B + b_size);
+    u.push_back(0);
+    shiftBitsLeft(u, shift);
+    shiftBitsLeft(v, shift);
+    u.resize(a_size + 1, 0);
+    const limb v_top = v[b_size - 1];
+    const limb v_next = v[b_size - 2];
+    for (size_t j = a_size - b_size + 1; j > 0;) {
+        --j;
+        dlimb top = (static_cast<dlimb>(u[j + b_size]) << 64) | u[j + b_size - 1];
+        dlimb q_hat = top / v_top;
+        dlimb r_hat = top % v_top;
+        while ((q_hat >> 64) || q_hat * v_next > ((r_hat << 64) | u[j + b_size - 2])) {
+            --q_hat;
+            r_hat += v_top;
+            if (r_hat >> 64) {
+                break;
+            }
+        }
+        limb q = static_cast<limb>(q_hat);
+        limb cashe = 0;
+        limb borrow = 0;
+        for (size_t i = 0; i < b_size; ++i) {
+            dlimb product = static_cast<dlimb>(q) * v[i] + cashe;
+            cashe = static_cast<limb>(product >> 64);
+            limb low = static_cast<limb>(product);
+            limb diff = u[i + j] - low;
+            limb under = u[i + j] < low;
+            u[i + j] = diff - borrow;
+            borrow = under | (diff < borrow);
+        }
+        limb diff = u[j + b_size] - cashe;
+        limb under = u[j + b_size] < cashe;
+        u[j + b_size] = diff - borrow;
+        borrow = under | (diff < borrow);
+        if (borrow) {
+            --q;
+            u[j + b_size] += addN(u.data() + j, u.data() + j, v.data(), b_size);
+        }
+        quotient[j] = q;
+    }
+    u.resize(b_size);
+    shiftBitsRight(u, shift);
+    std::copy(u.begin(), u.end(), remainder);
+    std::fill(remainder + u.size(), remainder + b_size, 0);
+}
+
+// Long division in base 2^(64n) for an n-limb divisor: each step divides a number below
+// B * 2^(64n) by B through the reciprocal V = floor(2^(128n) / B). Multiplying V by only the
+// top n + 1 limbs of that number undershoots the quotient by a few units, fixed by subtraction.
+// inverse, if given, is normalizedReciprocal(B) from an earlier call
+void BigInteger::divNewton(const limb_vector& A, const limb_vector& B,
+                           limb_vector& quotient, limb_vector& remainder, const limb_vector* inverse) {
+    int shift = __builtin_clzll(B.back());
+    limb_vector a(A);
+    limb_vector b(B);
+    shiftBitsLeft(a, shift);
+    shiftBitsLeft(b, shift);
+    const size_t n = b.size();
+    limb_vector computed;
+    if (!inverse) {
+        computed = reciprocal(b);
+        inverse = &computed;
+    }
+
+    size_t blocks = (a.size() + n - 1) / n;
+    quotient.assign(blocks * n, 0);
+    remainder.assign(1, 0);
+    for (size_t block = blocks; block > 0;) {
+        --block;
+        limb_vector current(a.begin() + block * n, a.begin() + std::min(a.size(), (block + 1) * n));
+        if (remainder.size() > 1 || remainder[0] != 0) {
+            current.resize(n, 0);
+            current.insert(current.end(), remainder.begin(), remainder.end());
+        }
+        trimVec(current);
+        if (cmpVec(current, b) < 0) {
+            remainder.swap(current);
+            continue;
+        }
+        limb_vector top(current.begin() + (n - 1), current.end());
+        limb_vector q = mulVec(top, *inverse);
+        q.erase(q.begin(), q.begin() + std::min(q.size(), n + 1));
+        trimVec(q);
+        limb_vector product = mulVec(q, b);
+        subVec(current, product);
+        trimVec(current);
+        while (cmpVec(current, b) >= 0) {
+            subVec(current, b);
+            trimVec(current);
+            sumVec(q, limb_vector(1, 1));
+        }
+        std::copy(q.begin(), q.end(), quotient.begin() + block * n);
+        remainder.swap(current);
+    }
+    trimVec(quotient);
+    shiftBitsRight(remainder, shift);
+}
+
+// The reciprocal divNewton uses for B: that of B shifted until its top bit is set
+limb_vector BigInteger::normalizedReciprocal(const limb_vector& B) {
+    limb_vector b(B);
+    shiftBitsLeft(b, __builtin_clzll(B.back()));
+    return reciprocal(b);
+}
+
+// floor(2^(128n) / B) for an n-limb B with the top bit set. The reciprocal of the top half of B
+// gives half the precision; one Newton step x += x * (2^(128n) - B * x) / 2^(128n) doubles it and
+// the few units of error left are corrected against the exact remainder.
+limb_vector BigInteger::reciprocal(const limb_vector& B) {
+    const size_t n = B.size();
+    limb_vector full(2 * n + 1, 0);
+    full[2 * n] = 1;
+    if (n < _newton_threshold) {
+        limb_vector x;
+        limb_vector rem;
+        divModVec(full, B, x, rem);
+        return x;
+    }
+    size_t h = (n + 1) / 2;
+    limb_vector x = reciprocal(limb_vector(B.end() - h, B.end()));
+    x.insert(x.begin(), n - h, 0);
+
+    limb_vector product = mulVec(B, x);
+    limb_vector error;
+    bool overshoot = cmpVec(product, full) > 0;
+    if (overshoot) {
+        error = product;
+        subVec(error, full);
+    }
+    else {
+        error = full;
+        subVec(error, product);
+    }
+    trimVec(error);
+    limb_vector step = mulVec(x, error);
+    step.erase(step.begin(), step.begin() + std::min(step.size(), 2 * n));
+    trimVec(step);
+    if (overshoot) {
+        subVec(x, step);
+    }
+    else {
+        sumVec(x, step);
+    }
+    trimVec(x);
+
+    const limb_vector one(1, 1);
+    product = mulVec(B, x);
+    while (cmpVec(product, full) > 0) {
+        subVec(x, one);
+        subVec(product, B);
+        trimVec(x);
+        trimVec(product);
+    }
+    subVec(full, product);
+    trimVec(full);
+    while (cmpVec(full, B) >= 0) {
+        sumVec(x, one);
+        subVec(full, B);
+        trimVec(full);
+    }
+    return x;
+}
+
+void BigInteger::shiftBitsLeft(limb_vector& vec, int shift) {
+    if (shift == 0) {
+        return;
+    }
+    limb cashe = 0;
+    for (size_t i = 0; i < vec.size(); ++i) {
+        limb next = vec[i] >> (64 - shift);
+        vec[i] = (vec[i] << shift) | cashe;
+        cashe = next;
+    }
+    if (cashe) {
+        vec.push_back(cashe);
+    }
+}
+
+void BigInteger::shiftBitsRight(limb_vector& vec, int shift) {
+    if (shift == 0) {
+        return;
+    }
+    for (size_t i = 0; i + 1 < vec.size(); ++i) {
+        vec[i] = (vec[i] >> shift) | (vec[i + 1] << (64 - shift));
+    }
+    vec.back() >>= shift;
+    trimVec(vec);
+}
+
+void BigInteger::shiftLeft(limb_vector& vec, size_t bits) {
+    if (vec.size() == 1 && vec[0] == 0) {
+        return;
+    }
+    vec.insert(vec.begin(), bits / 64, 0);
+    shiftBitsLeft(vec, static_cast<int>(bits % 64));
+}
+
+void BigInteger::shiftRight(limb_vector& vec, size_t bits) {
+    if (bits / 64 >= vec.size()) {
+        vec.assign(1, 0);
+        return;
+    }
+    vec.erase(vec.begin(), vec.begin() + bits / 64);
+    shiftBitsRight(vec, static_cast<int>(bits % 64));
+}
+
+// Position of the highest set bit plus one, 0 for zero
+size_t BigInteger::bitLength(const limb_vector& vec) {
+    size_t top = vec.size() - 1;
+    if (vec[top] == 0) {
+        return 0;
+    }
+    return 64 * top + static_cast<size_t>(64 - __builtin_clzll(vec[top]));
+}
+
+limb_vector BigInteger::mulVec(const limb_vector& A, const limb_vector& B) {
+    if (&A == &B) {
+        return sqrVec(A);
+    }
+    size_t n = std::max(A.size(), B.size());
+    if (std::min(A.size(), B.size()) < _karatsuba_threshold) {
+        limb_vector result(A.size() + B.size());
+        simpleMultiply(result.data(), A.data(), A.size(), B.data(), B.size());
+        trimVec(result);
+        return result;
+    }
+    if (n >= 2 * std::min(A.size(), B.size()) && std::min(A.size(), B.size()) < _ntt_threshold) {
+        return A.size() > B.size() ? mulUnbalanced(A, B) : mulUnbalanced(B, A);
+    }
+    if (n >= _ntt_threshold) {
+        return nttMultiply(A, B);
+    }
+    if (n >= _toom4_threshold) {
+        return toomCook(A, B, 4);
+    }
+    if (n >= _toom3_threshold) {
+        return toomCook(A, B, 3);
+    }
+    limb_vector a_padded;
+    limb_vector b_padded;
+    const limb* a = A.data();
+    const limb* b = B.data();
+    if (A.size() < n) {
+        a_padded = A;
+        a_padded.resize(n, 0);
+        a = a_padded.data();
+    }
+    if (B.size() < n) {
+        b_padded = B;
+        b_padded.resize(n, 0);
+        b = b_padded.data();
+    }
+    limb_vector result(2 * n);
+    limb_vector scratch(karatsubaScratch(n));
+    karatsuba(result.data(), a, b, n, scratch.data());
+    trimVec(result);
+    return result;
+}
+
+// A is at least twice as long as B: A is cut into B-sized chunks, each chunk is a balanced
+// product with B and is added in at its offset. Karatsuba-sized chunks are read in place
+// and share one scratch buffer.
+limb_vector BigInteger::mulUnbalanced(const limb_vector& A, const limb_vector& B) {
+    size_t m = B.size();
+    if (parallel(A.size())) {
+        // Split A in two on a chunk boundary; the halves' products overlap by B's length
+        size_t half = A.size() / (2 * m) * m;
+        limb_vector result;
+        limb_vector high;
+        _thread_pool->join([&]() {result = mulVec(limb_vector(A.begin(), A.begin() + half), B);},
+                           [&]() {high = mulVec(limb_vector(A.begin() + half, A.end()), B);});
+        result.resize(A.size() + m + 1, 0);
+        addTo(result.data() + half, result.size() - half, high.data(), high.size());
+        trimVec(result);
+        return result;
+    }
+    limb_vector result(A.size() + m + 1, 0);
+    if (m >= _toom3_threshold) {
+        for (size_t from = 0; from < A.size(); from += m) {
+            size_t to = std::min(A.size(), from + m);
+            limb_vector product = mulVec(limb_vector(A.begin() + from, A.begin() + to), B);
+            addTo(result.data() + from, result.size() - from, product.data(), product.size());
+        }
+        trimVec(result);
+        return result;
+    }
+    limb_vector product(2 * m);
+    limb_vector scratch(karatsubaScratch(m));
+    limb_vector tail(m, 0);
+    for (size_t from = 0; from < A.size(); from += m) {
+        const limb* chunk = A.data() + from;
+        if (A.size() - from < m) {
+            std::copy(A.begin() + from, A.end(), tail.begin());
+            chunk = tail.data();
+        }
+        karatsuba(product.data(), chunk, B.data(), m, scratch.data());
+        addTo(result.data() + from, result.size() - from, product.data(), std::min(2 * m, result.size() - from));
+    }
+    trimVec(result);
+    return result;
+}
+
+// result[0..2n) = A[0..n) * B[0..n). With A = a0 + a1 * 2^(64m) and the same for B the
+// middle term is a0*b0 + a1*b1 - (a0 - a1)(b0 - b1); the differences are kept as
+// magnitude plus sign, so every intermediate fits in the scratch laid out below.
+void BigInteger::karatsuba(limb* result, const limb* A, const limb* B, size_t n, limb* scratch) {
+    if (n < _karatsuba_threshold) {
+        simpleMultiply(result, A, n, B, n);
+        return;
+    }
+    size_t m = n / 2;
+    size_t h = n - m;
+    limb* a_diff = scratch;
+    limb* b_diff = a_diff + h;
+    limb* diff_product = b_diff + h;
+    limb* middle = diff_product + 2 * h;
+    limb* rest = middle + 2 * h + 1;
+
+    bool negative = absDiff(a_diff, A, m, A + m, h) != absDiff(b_diff, B, m, B + m, h);
+    if (parallel(n)) {
+        // Forked products cannot share rest, so two of them get scratch of their own
+        limb_vector high_scratch(karatsubaScratch(h));
+        limb_vector diff_scratch(karatsubaScratch(h));
+        _thread_pool->join([&]() {karatsuba(result, A, B, m, rest);}, [&]() {
+            _thread_pool->join([&]() {karatsuba(result + 2 * m, A + m, B + m, h, high_scratch.data());},
+                               [&]() {karatsuba(diff_product, a_diff, b_diff, h, diff_scratch.data());});
+        });
+    }
+    else {
+        karatsuba(result, A, B, m, rest);
+        karatsuba(result + 2 * m, A + m, B + m, h, rest);
+        karatsuba(diff_product, a_diff, b_diff, h, rest);
+    }
+
+    std::copy(result + 2 * m, result + 2 * n, middle);
+    middle[2 * h] = addTo(middle, 2 * h, result, 2 * m);
+    if (negative) {
+        addTo(middle, 2 * h + 1, diff_product, 2 * h);
+    }
+    else {
+        subFrom(middle, 2 * h + 1, diff_product, 2 * h);
+    }
+    addTo(result + m, n + h, middle, 2 * h + 1);
+}
+
+// The same tiers as mulVec, with the square specializations of schoolbook and Karatsuba
+limb_vector BigInteger::sqrVec(const limb_vector& A) {
+    size_t n = A.size();
+    if (n >= _ntt_threshold) {
+        return nttMultiply(A, A);
+    }
+    if (n >= _toom4_threshold) {
+        return toomCook(A, A, 4);
+    }
+    if (n >= _toom3_threshold) {
+        return toomCook(A, A, 3);
+    }
+    limb_vector result(2 * n);
+    if (n < _karatsuba_threshold) {
+        simpleSquare(result.data(), A.data(), n);
+    }
+    else {
+        limb_vector scratch(karatsubaScratch(n));
+        karatsubaSquare(result.data(), A.data(), n, scratch.data());
+    }
+    trimVec(result);
+    return result;
+}
+
+// (a1 x + a0)^2 = a1^2 x^2 + (a1^2 + a0^2 - (a0 - a1)^2) x + a0^2, three half-size squares
+// and no sign to track; scratch is laid out as in karatsuba
+void BigInteger::karatsubaSquare(limb* result, const limb* A, size_t n, limb* scratch) {
+    if (n < _karatsuba_threshold) {
+        simpleSquare(result, A, n);
+        return;
+    }
+    size_t m = n / 2;
+    size_t h = n - m;
+    limb* diff = scratch;
+    limb* diff_square = diff + h;
+    limb* middle = diff_square + 2 * h;
+    limb* rest = middle + 2 * h + 1;
+
+    absDiff(diff, A, m, A + m, h);
+    if (parallel(n)) {
+        limb_vector high_scratch(karatsubaScratch(h));
+        limb_vector diff_scratch(karatsubaScratch(h));
+        _thread_pool->join([&]() {karatsubaSquare(result, A, m, rest);}, [&]() {
+            _thread_pool->join([&]() {karatsubaSquare(result + 2 * m, A + m, h, high_scratch.data());},
+                               [&]() {karatsubaSquare(diff_square, diff, h, diff_scratch.data());});
+        });
+    }
+    else {
+        karatsubaSquare(result, A, m, rest);
+        karatsubaSquare(result + 2 * m, A + m, h, rest);
+        karatsubaSquare(diff_square, diff, h, rest);
+    }
+
+    std::copy(result + 2 * m, result + 2 * n, middle);
+    middle[2 * h] = addTo(middle, 2 * h, result, 2 * m);
+    subFrom(middle, 2 * h + 1, diff_square, 2 * h);
+    addTo(result + m, n + h, middle, 2 * h + 1);
+}
+
+size_t BigInteger::karatsubaScratch(size_t n) {
+    if (n < _karatsuba_threshold) {
+        return 0;
+    }
+    size_t h = n - n / 2;
+    return 6 * h + 1 + karatsubaScratch(h);
+}
+
+// Toom-k: A and B are cut into k pieces each, i.e. read as polynomials of degree k - 1 in
+// 2^(64 * part). Their product r of degree 2k - 2 is evaluated at infinity (the product of
+// the top pieces) and at 2k - 2 small integer points 0, 1, -1, 2, -2, ... The rest of r is
+// interpolated in Newton form: for integer nodes every divided difference of an integer
+// polynomial is an integer, so all divisions by node differences are exact.
+limb_vector BigInteger::toomCook(const limb_vector& A, const limb_vector& B, size_t k) {
+    const bool square = &A == &B;
+    size_t part = (std::max(A.size(), B.size()) + k - 1) / k;
+    std::vector<BigInteger> a;
+    std::vector<BigInteger> b;
+    for (size_t i = 0; i < k; ++i) {
+        size_t from = std::min(A.size(), i * part);
+        size_t to = std::min(A.size(), from + part);
+        a.push_back(BigInteger(limb_vector(A.begin() + from, A.begin() + to), POSITIVE));
+        from = std::min(B.size(), i * part);
+        to = std::min(B.size(), from + part);
+        b.push_back(BigInteger(limb_vector(B.begin() + from, B.begin() + to), POSITIVE));
+    }
+    size_t count = 2 * k - 2;
+    std::vector<int> points;
+    for (int x = 0; points.size() < count; ++x) {
+        points.push_back(x);
+        if (x != 0 && points.size() < count) {
+            points.push_back(-x);
+        }
+    }
+    std::vector<BigInteger> values(count);
+    std::vector<BigInteger> values_b(square ? 0 : count);
+    for (size_t j = 0; j < count; ++j) {
+        int x = points[j];
+        values[j] = a[k - 1];
+        for (size_t i = k - 1; i > 0;) {
+            --i;
+            values[j] *= x;
+            values[j] += a[i];
+        }
+        if (!square) {
+            values_b[j] = b[k - 1];
+            for (size_t i = k - 1; i > 0;) {
+                --i;
+                values_b[j] *= x;
+                values_b[j] += b[i];
+            }
+        }
+    }
+    // The 2k - 1 pointwise products are independent; the last one is at infinity
+    BigInteger top;
+    forkEach(k * part, count + 1, [&](size_t j) {
+        if (j == count) {
+            top = square ? sqr(a[k - 1]) : a[k - 1] * b[k - 1];
+        }
+        else {
+            values[j] = square ? sqr(values[j]) : values[j] * values_b[j];
+        }
+    });
+    for (size_t j = 0; j < count; ++j) {
+        int top_power = 1;
+        for (size_t i = 0; i < count; ++i) {
+            top_power *= points[j];
+        }
+        BigInteger top_term(top);
+        top_term *= top_power;
+        values[j] -= top_term;
+    }
+    for (size_t level = 1; level < count; ++level) {
+        for (size_t j = count - 1; j >= level; --j) {
+            values[j] -= values[j - 1];
+            values[j] /= points[j] - points[j - level];
+        }
+    }
+    std::vector<BigInteger> coefficients(1, values[count - 1]);
+    for (size_t j = count - 1; j > 0;) {
+        --j;
+        coefficients.push_back(coefficients.back());
+        for (size_t i = coefficients.size() - 2; i > 0; --i) {
+            coefficients[i] *= -points[j];
+            coefficients[i] += coefficients[i - 1];
+        }
+        coefficients[0] *= -points[j];
+        coefficients[0] += values[j];
+    }
+    coefficients.push_back(top);
+
+    limb_vector result(2 * k * part + 2, 0);
+    for (size_t i = 0; i < coefficients.size(); ++i) {
+        const limb_vector& coefficient = coefficients[i]._bits;
+        addTo(result.data() + i * part, result.size() - i * part, coefficient.data(), coefficient.size());
+    }
+    trimVec(result);
+    return result;
+}
+
+// Convolution of the limbs modulo three primes close to 2^62. Every coefficient is below
+// n * 2^128 < p1 * p2 * p3, so Garner's CRT recovers it exactly as a three-limb number.
+limb_vector BigInteger::nttMultiply(const limb_vector& A, const limb_vector& B) {
+    static const NttPrime primes[3] = {NttPrime(0x3fffc00000000001ULL, 11),
+                                       NttPrime(0x3ffac00000000001ULL, 3),
+                                       NttPrime(0x3febc00000000001ULL, 3)};
+    size_t n = 1;
+    while (n < A.size() + B.size()) {
+        n <<= 1;
+    }
+    limb_vector residues[3];
+    forkEach(n, 3, [&](size_t k) {
+        const NttPrime& prime = primes[k];
+        limb_vector fa(n, 0);
+        for (size_t i = 0; i < A.size(); ++i) {
+            fa[i] = prime.toMont(A[i]);
+        }
+        ntt(fa, false, prime);
+        if (&A == &B) {
+            for (size_t i = 0; i < n; ++i) {
+                fa[i] = prime.mul(fa[i], fa[i]);
+            }
+        }
+        else {
+            limb_vector fb(n, 0);
+            for (size_t i = 0; i < B.size(); ++i) {
+                fb[i] = prime.toMont(B[i]);
+            }
+            ntt(fb, false, prime);
+            for (size_t i = 0; i < n; ++i) {
+                fa[i] = prime.mul(fa[i], fb[i]);
+            }
+        }
+        ntt(fa, true, prime);
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = prime.fromMont(fa[i]);
+        }
+        residues[k].swap(fa);
+    });
+
+    const NttPrime& p1 = primes[0];
+    const NttPrime& p2 = primes[1];
+    const NttPrime& p3 = primes[2];
+    // Montgomery images of p1^-1 mod p2, p1 mod p3 and (p1 * p2)^-1 mod p3, so that
+    // mul(x, c) is the plain modular product x * c
+    const limb inv_p1 = p2.pow(p2.toMont(p1.mod), p2.mod - 2);
+    const limb p1_mod_p3 = p3.toMont(p1.mod);
+    const limb inv_p1p2 = p3.pow(p3.mul(p1_mod_p3, p3.toMont(p2.mod)), p3.mod - 2);
+    const dlimb p1p2 = static_cast<dlimb>(p1.mod) * p2.mod;
+
+    limb_vector result(n + 3, 0);
+    for (size_t i = 0; i < A.size() + B.size(); ++i) {
+        limb v1 = residues[0][i];
+        limb v1_mod_p2 = v1 >= p2.mod ? v1 - p2.mod : v1;
+        limb x2 = residues[1][i] >= v1_mod_p2 ? residues[1][i] - v1_mod_p2 : residues[1][i] + p2.mod - v1_mod_p2;
+        limb v2 = p2.mul(x2, inv_p1);
+        limb v1_mod_p3 = v1 >= p3.mod ? v1 - p3.mod : v1;
+        limb v2_mod_p3 = v2 >= p3.mod ? v2 - p3.mod : v2;
+        limb sub = v1_mod_p3 + p3.mul(v2_mod_p3, p1_mod_p3);
+        sub = sub >= p3.mod ? sub - p3.mod : sub;
+        limb x3 = residues[2][i] >= sub ? residues[2][i] - sub : residues[2][i] + p3.mod - sub;
+        limb v3 = p3.mul(x3, inv_p1p2);
+
+        dlimb low = static_cast<dlimb>(v2) * p1.mod + v1;
+        dlimb mid_low = static_cast<dlimb>(v3) * static_cast<limb>(p1p2);
+        dlimb mid_high = static_cast<dlimb>(v3) * static_cast<limb>(p1p2 >> 64);
+        limb value[3];
+        dlimb cur = static_cast<dlimb>(static_cast<limb>(low)) + static_cast<limb>(mid_low);
+        value[0] = static_cast<limb>(cur);
+        cur = (cur >> 64) + (low >> 64) + (mid_low >> 64) + static_cast<limb>(mid_high);
+        value[1] = static_cast<limb>(cur);
+        value[2] = static_cast<limb>((cur >> 64) + (mid_high >> 64));
+        addTo(result.data() + i, result.size() - i, value, 3);
+    }
+    trimVec(result);
+    return result;
+}
+
+void BigInteger::ntt(limb_vector& values, bool invert, const NttPrime& prime) {
+    size_t n = values.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(values[i], values[j]);
+        }
+    }
+    const limb one = prime.toMont(1);
+    limb_vector twiddles;
+    for (size_t len = 2; len <= n; len <<= 1) {
+        limb root = prime.pow(prime.toMont(prime.root), (prime.mod - 1) / len);
+        if (invert) {
+            root = prime.pow(root, prime.mod - 2);
+        }
+        size_t half = len / 2;
+        twiddles.assign(1, one);
+        for (size_t j = 1; j < half; ++j) {
+            twiddles.push_back(prime.mul(twiddles.back(), root));
+        }
+        // The butterflies of a stage are independent: tasks take runs of blocks, or of columns
+        // j within every block once there are fewer blocks than tasks
+        size_t blocks = n / len;
+        size_t tasks = parallel(n) ? std::min(n / _parallel_threshold, static_cast<size_t>(64)) : 1;
+        forkEach(n, tasks, [&](size_t task) {
+            bool by_block = blocks >= tasks;
+            size_t block_from = by_block ? blocks * task / tasks : 0;
+            size_t block_to = by_block ? blocks * (task + 1) / tasks : blocks;
+            size_t j_from = by_block ? 0 : half * task / tasks;
+            size_t j_to = by_block ? half : half * (task + 1) / tasks;
+            for (size_t i = block_from * len; i < block_to * len; i += len) {
+                for (size_t j = j_from; j < j_to; ++j) {
+                    limb u = values[i + j];
+                    limb v = prime.mul(values[i + j + half], twiddles[j]);
+                    limb sum = u + v;
+                    values[i + j] = sum >= prime.mod ? sum - prime.mod : sum;
+                    values[i + j + half] = u >= v ? u - v : u + prime.mod - v;
+                }
+            }
+        });
+    }
+    if (invert) {
+        limb n_inv = prime.pow(prime.toMont(n), prime.mod - 2);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = prime.mul(values[i], n_inv);
+        }
+    }
+}
+
+BigInteger::NttPrime::NttPrime(limb new_mod, limb new_root) : mod(new_mod), root(new_root) {
+    limb inv = mod;
+    for (int i = 0; i < 5; ++i) {
+        inv *= 2 - mod * inv;
+    }
+    neg_inv = 0 - inv;
+    limb r = (0 - mod) % mod;
+    r2 = static_cast<limb>(static_cast<dlimb>(r) * r % mod);
+}
+
+limb BigInteger::NttPrime::mul(limb lhs, limb rhs) const {
+    dlimb product = static_cast<dlimb>(lhs) * rhs;
+    limb m = static_cast<limb>(product) * neg_inv;
+    limb result = static_cast<limb>((product + static_cast<dlimb>(m) * mod) >> 64);
+    return result >= mod ? result - mod : result;
+}
+
+limb BigInteger::NttPrime::pow(limb base, limb exp) const {
+    limb result = toMont(1);
+    while (exp) {
+        if (exp & 1) {
+            result = mul(result, base);
+        }
+        base = mul(base, base);
+        exp >>= 1;
+    }
+    return result;
+}
+
+limb BigInteger::addN(limb* result, const limb* lhs, const limb* rhs, size_t n) {
+    return n < _simd_min_limbs ? addScalar(result, lhs, rhs, n, 0) : _add_kernel(result, lhs, rhs, n, 0);
+}
+
+limb BigInteger::subN(limb* result, const limb* lhs, const limb* rhs, size_t n) {
+    return n < _simd_min_limbs ? subScalar(result, lhs, rhs, n, 0) : _sub_kernel(result, lhs, rhs, n, 0);
+}
+
+// Three-way comparison of lhs[0..n) and rhs[0..n)
+int BigInteger::cmpN(const limb* lhs, const limb* rhs, size_t n) {
+    return n < _simd_min_limbs ? cmpScalar(lhs, rhs, n) : _cmp_kernel(lhs, rhs, n);
+}
+
+// lhs[0..lhs_size) += rhs[0..rhs_size), rhs_size <= lhs_size; returns the carry out
+limb BigInteger::addTo(limb* lhs, size_t lhs_size, const limb* rhs, size_t rhs_size) {
+    limb cashe = addN(lhs, lhs, rhs, rhs_size);
+    for (size_t i = rhs_size; cashe && i < lhs_size; ++i) {
+        cashe = ++lhs[i] == 0;
+    }
+    return cashe;
+}
+
+// lhs[0..lhs_size) -= rhs[0..rhs_size), rhs_size <= lhs_size; returns the borrow out
+limb BigInteger::subFrom(limb* lhs, size_t lhs_size, const limb* rhs, size_t rhs_size) {
+    limb cashe = subN(lhs, lhs, rhs, rhs_size);
+    for (size_t i = rhs_size; cashe && i < lhs_size; ++i) {
+        cashe = lhs[i]-- == 0;
+    }
+    return cashe;
+}
+
+// result[0..n) += A[0..n) * mul; returns the carry limb
+limb BigInteger::mulAddRow(limb* result, const limb* A, size_t n, limb mul) {
+    limb cashe = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb cur = static_cast<dlimb>(A[i]) * mul + result[i] + cashe;
+        result[i] = static_cast<limb>(cur);
+        cashe = static_cast<limb>(cur >> 64);
+    }
+    return cashe;
+}
+
+// result[0..n) -= A[0..n) * mul; returns the borrow limb
+limb BigInteger::mulSubRow(limb* result, const limb* A, size_t n, limb mul) {
+    limb cashe = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb product = static_cast<dlimb>(A[i]) * mul + cashe;
+        limb low = static_cast<limb>(product);
+        cashe = static_cast<limb>(product >> 64) + (result[i] < low);
+        result[i] -= low;
+    }
+    return cashe;
+}
+
+// result[0..rhs_size) = |lhs - rhs| for lhs_size <= rhs_size; returns true if lhs < rhs
+bool BigInteger::absDiff(limb* result, const limb* lhs, size_t lhs_size, const limb* rhs, size_t rhs_size) {
+    bool less = false;
+    size_t i = rhs_size;
+    while (i > lhs_size && rhs[i - 1] == 0) {
+        --i;
+    }
+    if (i > lhs_size) {
+        less = true;
+    }
+    else {
+        while (i > 0 && lhs[i - 1] == rhs[i - 1]) {
+            --i;
+        }
+        less = i > 0 && lhs[i - 1] < rhs[i - 1];
+    }
+    if (less) {
+        limb borrow = subN(result, rhs, lhs, lhs_size);
+        for (size_t j = lhs_size; j < rhs_size; ++j) {
+            result[j] = rhs[j] - borrow;
+            borrow = borrow && rhs[j] == 0;
+        }
+    }
+    else {
+        subN(result, lhs, rhs, lhs_size);
+        std::fill(result + lhs_size, result + rhs_size, 0);
+    }
+    return less;
+}
+
+void BigInteger::trimVec(limb_vector& vec) {
+    while (vec.size() > 1 && vec.back() == 0) {
+        vec.pop_back();
+    }
+    if (vec.empty()) {
+        vec.push_back(0);
+    }
+}
+
+void BigInteger::rmInsignNulls() {
+    trimVec(_bits);
+}
+
+void BigInteger::simpleMultiply(limb* result, const limb* A, size_t a_size, const limb* B, size_t b_size) {
+    std::fill(result, result + a_size + b_size, 0);
+    for (size_t i = 0; i < a_size; ++i) {
+        limb cashe = 0;
+        for (size_t j = 0; j < b_size; ++j) {
+            dlimb tmp_num = static_cast<dlimb>(A[i]) * B[j] + result[i + j] + cashe;
+            result[i + j] = static_cast<limb>(tmp_num);
+            cashe = static_cast<limb>(tmp_num >> 64);
+        }
+        result[i + b_size] = cashe;
+    }
+}
+
+// Every cross product A[i] * A[j], i < j, is formed once and doubled by a shift, then the
+// squares A[i]^2 go on the diagonal
+void BigInteger::simpleSquare(limb* result, const limb* A, size_t n) {
+    std::fill(result, result + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        result[i + n] = mulAddRow(result + 2 * i + 1, A + i + 1, n - i - 1, A[i]);
+    }
+    for (size_t i = 2 * n; i > 1;) {
+        --i;
+        result[i] = (result[i] << 1) | (result[i - 1] >> 63);
+    }
+    result[0] <<= 1;
+    limb cashe = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dlimb square = static_cast<dlimb>(A[i]) * A[i];
+        dlimb cur = static_cast<dlimb>(result[2 * i]) + static_cast<limb>(square) + cashe;
+        result[2 * i] = static_cast<limb>(cur);
+        cur = (cur >> 64) + result[2 * i + 1] + static_cast<limb>(square >> 64);
+        result[2 * i + 1] = static_cast<limb>(cur);
+        cashe = static_cast<limb>(cur >> 64);
+    }
+}
+
+// Value of the 8 ASCII digits at str, most significant first. SWAR: the word is read at once and
+// neighbouring digits, then pairs, then quadruples are merged in place.
+limb BigInteger::parseEight(const char* str) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    limb chunk;
+    std::memcpy(&chunk, str, 8);
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00ff00ff00ff00ffULL;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000ffff0000ffffULL;
+    return (chunk * 10000 + (chunk >> 32)) & 0x00000000ffffffffULL;
+#else
+    limb value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value = value * 10 + static_cast<limb>(str[i] - '0');
+    }
+    return value;
+#endif
+}
+
+// Horner's rule over 19-digit groups, straight into the result
+limb_vector BigInteger::parseSmall(std::string_view str) {
+    limb_vector result(1, 0);
+    size_t from = 0;
+    size_t to = str.size() % _dec_digits == 0 ? _dec_digits : str.size() % _dec_digits;
+    for (; from < str.size(); from = to, to += _dec_digits) {
+        limb group = 0;
+        size_t i = from;
+        for (; i + 8 <= to; i += 8) {
+            group = group * 100000000 + parseEight(str.data() + i);
+        }
+        for (; i < to; ++i) {
+            group = group * 10 + static_cast<limb>(str[i] - '0');
+        }
+        mulSmall(result, from == 0 ? 1 : _dec_base, group);
+    }
+    return result;
+}
+
+// powers[k] = 10^(19 * 2^k), up to the first one whose square has more limbs than given
+std::vector<limb_vector> BigInteger::decimalPowers(size_t limbs) {
+    std::vector<limb_vector> powers(1, limb_vector(1, _dec_base));
+    while (2 * powers.back().size() - 1 <= limbs) {
+        powers.push_back(sqrVec(powers.back()));
+    }
+    return powers;
+}
+
+// Short inputs go by Horner's rule; longer ones are cut at a power 10^(19 * 2^k) and the halves joined
+// with one multiplication, which only views the input and never copies it.
+limb_vector BigInteger::parseDecimal(std::string_view str) {
+    if (str.size() <= _dec_digits * _dec_dc_threshold) {
+        return parseSmall(str);
+    }
+    // 19 digits need at most one limb, so this many limbs bound the value
+    std::vector<limb_vector> powers = decimalPowers(str.size() / _dec_digits + 1);
+    return parseRange(str, powers, powers.size());
+}
+
+limb_vector BigInteger::parseRange(std::string_view str, const std::vector<limb_vector>& powers, size_t level) {
+    if (level == 0 || str.size() <= _dec_digits * _dec_dc_threshold) {
+        return parseSmall(str);
+    }
+    size_t low_width = static_cast<size_t>(_dec_digits) << (level - 1);
+    if (str.size() <= low_width) {
+        return parseRange(str, powers, level - 1);
+    }
+    limb_vector result = parseRange(str.substr(0, str.size() - low_width), powers, level);
+    result = mulVec(result, powers[level - 1]);
+    sumVec(result, parseRange(str.substr(str.size() - low_width), powers, level - 1));
+    return result;
+}
+
+// Prints A < powers[level]^2 using powers[0..level-1]; a nonzero width pads with leading zeros
+void BigInteger::printDecimal(std::string& out, const limb_vector& A, const std::vector<limb_vector>& powers,
+                              const std::vector<limb_vector>& inverses, size_t level, size_t width) {
+    if (level == 0 || A.size() <= _dec_dc_threshold) {
+        printSmall(out, A, width);
+        return;
+    }
+    const limb_vector& power = powers[level - 1];
+    if (cmpVec(A, power) < 0) {
+        printDecimal(out, A, powers, inverses, level - 1, width);
+        return;
+    }
+    limb_vector high;
+    limb_vector low;
+    if (inverses[level - 1].size() > 1) {
+        divNewton(A, power, high, low, &inverses[level - 1]);
+    }
+    else {
+        divModVec(A, power, high, low);
+    }
+    size_t low_width = static_cast<size_t>(_dec_digits) << (level - 1);
+    printDecimal(out, high, powers, inverses, level - 1, width > low_width ? width - low_width : 0);
+    printDecimal(out, low, powers, inverses, level - 1, low_width);
+}
+
+// A has at most _dec_dc_threshold limbs; its 19-digit groups are written right to left into
+// the tail of out, which padding has already filled with zeros
+void BigInteger::printSmall(std::string& out, limb_vector A, size_t width) {
+    limb groups[2 * _dec_dc_threshold + 2];
+    size_t count = 0;
+    while (A.size() > 1 || A[0] != 0) {
+        groups[count++] = divSmall(A, _dec_base);
+    }
+    size_t top_digits = 0;
+    for (limb top = count ? groups[count - 1] : 0; top; top /= 10) {
+        ++top_digits;
+    }
+    size_t digits = count ? (count - 1) * _dec_digits + top_digits : 0;
+    size_t total = std::max(std::max(digits, width), static_cast<size_t>(width == 0));
+    out.resize(out.size() + total, '0');
+    char* end = &out[0] + out.size();
+    for (size_t i = 0; i < count; ++i) {
+        size_t group_digits = i + 1 == count ? top_digits : _dec_digits;
+        printGroup(end - i * _dec_digits - group_digits, groups[i], group_digits);
+    }
+}
+
+// Writes exactly `digits` digits of group at out, two at a time from a table of all pairs
+void BigInteger::printGroup(char* out, limb group, size_t digits) {
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    while (digits >= 2) {
+        digits -= 2;
+        std::memcpy(out + digits, pairs + 2 * (group % 100), 2);
+        group /= 100;
+    }
+    if (digits) {
+        out[0] = static_cast<char>('0' + group % 10);
+    }
+}
+
+// Bytes 8i to 8i + 7 of the number in out[0, size), cut short at size. On little-endian
+// hosts a whole limb is a single copy, byte-swapped first for big-endian order.
+void BigInteger::storeLimb(unsigned char* out, size_t size, size_t i, limb value, ByteOrder order) {
+    size_t count = std::min<size_t>(8, size - 8 * i);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (count == 8) {
+        if (order == ByteOrder::BIG) {
+            value = __builtin_bswap64(value);
+        }
+        std::memcpy(order == ByteOrder::LITTLE ? out + 8 * i : out + size - 8 * i - 8, &value, 8);
+        return;
+    }
+#endif
+    for (size_t j = 0; j < count; ++j) {
+        size_t at = order == ByteOrder::LITTLE ? 8 * i + j : size - 1 - 8 * i - j;
+        out[at] = static_cast<unsigned char>(value >> (8 * j));
+    }
+}
+
+// The inverse of storeLimb; a limb cut short at size is topped up with the bytes of fill
+limb BigInteger::loadLimb(const unsigned char* data, size_t size, size_t i, ByteOrder order, limb fill) {
+    size_t count = std::min<size_t>(8, size - 8 * i);
+    limb value = 0;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (count == 8) {
+        std::memcpy(&value, order == ByteOrder::LITTLE ? data + 8 * i : data + size - 8 * i - 8, 8);
+        return order == ByteOrder::LITTLE ? value : __builtin_bswap64(value);
+    }
+#endif
+    for (size_t j = 0; j < count; ++j) {
+        size_t at = order == ByteOrder::LITTLE ? 8 * i + j : size - 1 - 8 * i - j;
+        value |= static_cast<limb>(data[at]) << (8 * j);
+    }
+    if (count < 8) {
+        value |= fill << (8 * count);
+    }
+    return value;
+}
+
+limb BigInteger::hexDigit(char c) {
+    return c <= '9' ? static_cast<limb>(c - '0') : static_cast<limb>((c | 0x20) - 'a' + 10);
+}
+
+// _____________________________________CARRY_KERNELS_____________________________________
+// result = lhs + rhs + cashe over n limbs, returns the carry out. Aliasing result with an input is fine.
+limb BigInteger::addScalar(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe) {
+    for (size_t i = 0; i < n; ++i) {
+        limb sum = lhs[i] + rhs[i];
+        limb carry = sum < rhs[i];
+        result[i] = sum + cashe;
+        cashe = carry | (result[i] < sum);
+    }
+    return cashe;
+}
+
+limb BigInteger::subScalar(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe) {
+    for (size_t i = 0; i < n; ++i) {
+        limb diff = lhs[i] - rhs[i];
+        limb borrow = lhs[i] < rhs[i];
+        result[i] = diff - cashe;
+        cashe = borrow | (diff < cashe);
+    }
+    return cashe;
+}
+
+int BigInteger::cmpScalar(const limb* lhs, const limb* rhs, size_t n) {
+    for (size_t i = n; i > 0;) {
+        --i;
+        if (lhs[i] != rhs[i]) {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// 2 = AVX2, 1 = SSE4.2, 0 = neither
+int BigInteger::simdLevel() {
+#ifdef BIGINTEGER_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return 2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+#ifdef BIGINTEGER_X86_SIMD
+// The vector kernels add all lanes at once and resolve carries by lookahead: with g the lanes that
+// overflow by themselves and p the lanes that are all ones (and so pass an incoming carry on), the
+// carry into each lane is a bit of ((g | p) + g + cashe) ^ p, and the bit above the lanes carries out.
+// For subtraction g are the lanes that borrow and p the lanes that came out zero.
+__attribute__((target("avx2")))
+limb BigInteger::addAvx2(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe) {
+    const __m256i sign_bit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i lane_bits = _mm256_set_epi64x(8, 4, 2, 1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        __m256i sum = _mm256_add_epi64(a, b);
+        __m256i gen = _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign_bit), _mm256_xor_si256(sum, sign_bit));
+        __m256i prop = _mm256_cmpeq_epi64(sum, ones);
+        limb g = _mm256_movemask_pd(_mm256_castsi256_pd(gen));
+        limb p = _mm256_movemask_pd(_mm256_castsi256_pd(prop));
+        limb carries = ((g | p) + g + cashe) ^ p;
+        __m256i carry_in = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(carries), lane_bits), lane_bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_sub_epi64(sum, carry_in));
+        cashe = carries >> 4;
+    }
+    return addScalar(result + i, lhs + i, rhs + i, n - i, cashe);
+}
+
+__attribute__((target("avx2")))
+limb BigInteger::subAvx2(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe) {
+    const __m256i sign_bit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lane_bits = _mm256_set_epi64x(8, 4, 2, 1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        __m256i diff = _mm256_sub_epi64(a, b);
+        __m256i gen = _mm256_cmpgt_epi64(_mm256_xor_si256(b, sign_bit), _mm256_xor_si256(a, sign_bit));
+        __m256i prop = _mm256_cmpeq_epi64(diff, zero);
+        limb g = _mm256_movemask_pd(_mm256_castsi256_pd(gen));
+        limb p = _mm256_movemask_pd(_mm256_castsi256_pd(prop));
+        limb borrows = ((g | p) + g + cashe) ^ p;
+        __m256i borrow_in = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(borrows), lane_bits), lane_bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_add_epi64(diff, borrow_in));
+        cashe = borrows >> 4;
+    }
+    return subScalar(result + i, lhs + i, rhs + i, n - i, cashe);
+}
+
+// Scans down four limbs at a time for the first that differs
+__attribute__((target("avx2")))
+int BigInteger::cmpAvx2(const limb* lhs, const limb* rhs, size_t n) {
+    size_t i = n;
+    while (i >= 4) {
+        i -= 4;
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        int equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+        if (equal != 15) {
+            size_t top = i + 31 - __builtin_clz(~equal & 15);
+            return lhs[top] < rhs[top] ? -1 : 1;
+        }
+    }
+    return cmpScalar(lhs, rhs, i);
+}
+
+__attribute__((target("sse4.2")))
+limb BigInteger::addSse42(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe) {
+    const __m128i sign_bit = _mm_set1_epi64x(INT64_MIN);
+    const __m128i ones = _mm_set1_epi64x(-1);
+    const __m128i lane_bits = _mm_set_epi64x(2, 1);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        __m128i sum = _mm_add_epi64(a, b);
+        __m128i gen = _mm_cmpgt_epi64(_mm_xor_si128(a, sign_bit), _mm_xor_si128(sum, sign_bit));
+        __m128i prop = _mm_cmpeq_epi64(sum, ones);
+        limb g = _mm_movemask_pd(_mm_castsi128_pd(gen));
+        limb p = _mm_movemask_pd(_mm_castsi128_pd(prop));
+        limb carries = ((g | p) + g + cashe) ^ p;
+        __m128i carry_in = _mm_cmpeq_epi64(_mm_and_si128(_mm_set1_epi64x(carries), lane_bits), lane_bits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_sub_epi64(sum, carry_in));
+        cashe = carries >> 2;
+    }
+    return addScalar(result + i, lhs + i, rhs + i, n - i, cashe);
+}
+
+__attribute__((target("sse4.2")))
+limb BigInteger::subSse42(limb* result, const limb* lhs, const limb* rhs, size_t n, limb cashe) {
+    const __m128i sign_bit = _mm_set1_epi64x(INT64_MIN);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lane_bits = _mm_set_epi64x(2, 1);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        __m128i diff = _mm_sub_epi64(a, b);
+        __m128i gen = _mm_cmpgt_epi64(_mm_xor_si128(b, sign_bit), _mm_xor_si128(a, sign_bit));
+        __m128i prop = _mm_cmpeq_epi64(diff, zero);
+        limb g = _mm_movemask_pd(_mm_castsi128_pd(gen));
+        limb p = _mm_movemask_pd(_mm_castsi128_pd(prop));
+        limb borrows = ((g | p) + g + cashe) ^ p;
+        __m128i borrow_in = _mm_cmpeq_epi64(_mm_and_si128(_mm_set1_epi64x(borrows), lane_bits), lane_bits);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(result + i), _mm_add_epi64(diff, borrow_in));
+        cashe = borrows >> 2;
+    }
+    return subScalar(result + i, lhs + i, rhs + i, n - i, cashe);
+}
+
+__attribute__((target("sse4.2")))
+int BigInteger::cmpSse42(const limb* lhs, const limb* rhs, size_t n) {
+    size_t i = n;
+    while (i >= 2) {
+        i -= 2;
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        int equal = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(a, b)));
+        if (equal != 3) {
+            size_t top = i + ((equal & 2) ? 0 : 1);
+            return lhs[top] < rhs[top] ? -1 : 1;
+        }
+    }
+    return cmpScalar(lhs, rhs, i);
+}
+#endif
+
+// _____________________________________AUXILIARY_FUNCTIONS_____________________________________
+void BigInteger::setMulThresholds(size_t karatsuba, size_t toom3, size_t toom4, size_t ntt) {
+    // Karatsuba needs two limbs to split and Toom three, anything lower never terminates
+    _karatsuba_threshold = std::max(karatsuba, static_cast<size_t>(2));
+    _toom3_threshold = std::max(toom3, static_cast<size_t>(3));
+    _toom4_threshold = std::max(toom4, static_cast<size_t>(3));
+    _ntt_threshold = ntt;
+}
+
+void BigInteger::setThreadPool(BigIntegerThreadPool* pool, size_t min_limbs) {
+    _thread_pool = pool;
+    _parallel_threshold = min_limbs;
+}
+
+BigInteger abs(const BigInteger& num) {
+    BigInteger pos_num(num);
+    if (pos_num._sign == NEGATIVE) {
+        pos_num._sign = POSITIVE;
+    }
+    return pos_num;
+}
+
+BigInteger abs(BigInteger&& num) {
+    if (num._sign == NEGATIVE) {
+        num._sign = POSITIVE;
+    }
+    return std::move(num);
+}
+
+// _____________________________________POWERS_____________________________________
+BigInteger sqr(const BigInteger& num) {
+    if (num._sign == ZERO) {
+        return BigInteger();
+    }
+    return BigInteger(BigInteger::sqrVec(num._bits), POSITIVE);
+}
+
+BigInteger pow(const BigInteger& base, uint64_t exp) {
+    if (exp == 0) {
+        return BigInteger(1);
+    }
+    if (base._sign == ZERO) {
+        return BigInteger();
+    }
+    auto square = [](const limb_vector& A) {return BigInteger::sqrVec(A);};
+    auto multiply = [](const limb_vector& A, const limb_vector& B) {return BigInteger::mulVec(A, B);};
+    limb_vector result = BigInteger::slidingWindowPow(base._bits, limb_vector(1, exp), square, multiply);
+    return BigInteger(std::move(result), base._sign == NEGATIVE && (exp & 1) ? NEGATIVE : POSITIVE);
+}
+
+// Odd moduli work in Montgomery form, so each step is a product and a word-by-word REDC instead
+// of a long division; even moduli reduce each product by division.
+BigInteger powmod(const BigInteger& base, const BigInteger& exp, const BigInteger& mod) {
+    const limb_vector& m = mod._bits;
+    if (m.size() == 1 && m[0] == 1) {
+        return BigInteger();
+    }
+    limb_vector quotient;
+    limb_vector x;
+    BigInteger::divModVec(base._bits, m, quotient, x);
+    if (base._sign == NEGATIVE && (x.size() > 1 || x[0] != 0)) {
+        limb_vector reduced(m);
+        BigInteger::subVec(reduced, x);
+        BigInteger::trimVec(reduced);
+        x.swap(reduced);
+    }
+    if (exp._sign == ZERO) {
+        return BigInteger(1);
+    }
+    if (x.size() == 1 && x[0] == 0) {
+        return BigInteger();
+    }
+    if (!(m[0] & 1)) {
+        auto reduce = [&m](limb_vector T) {
+            limb_vector quotient;
+            limb_vector remainder;
+            BigInteger::divModVec(T, m, quotient, remainder);
+            return remainder;
+        };
+        auto square = [&reduce](const limb_vector& A) {return reduce(BigInteger::sqrVec(A));};
+        auto multiply = [&reduce](const limb_vector& A, const limb_vector& B) {return reduce(BigInteger::mulVec(A, B));};
+        return BigInteger(BigInteger::slidingWindowPow(x, exp._bits, square, multiply), POSITIVE);
+    }
+    // -m^-1 mod 2^64 by Newton's iteration, each step doubles the correct low bits
+    limb inv = m[0];
+    for (int i = 0; i < 6; ++i) {
+        inv *= 2 - m[0] * inv;
+    }
+    const limb neg_inv = 0 - inv;
+    // Into Montgomery form: x * 2^(64n) mod m
+    limb_vector shifted(m.size(), 0);
+    shifted.insert(shifted.end(), x.begin(), x.end());
+    limb_vector x_mont;
+    BigInteger::divModVec(shifted, m, quotient, x_mont);
+    auto square = [&m, neg_inv](const limb_vector& A) {
+        limb_vector T = BigInteger::sqrVec(A);
+        BigInteger::montgomeryReduce(T, m, neg_inv);
+        return T;
+    };
+    auto multiply = [&m, neg_inv](const limb_vector& A, const limb_vector& B) {
+        limb_vector T = BigInteger::mulVec(A, B);
+        BigInteger::montgomeryReduce(T, m, neg_inv);
+        return T;
+    };
+    limb_vector result = BigInteger::slidingWindowPow(x_mont, exp._bits, square, multiply);
+    BigInteger::montgomeryReduce(result, m, neg_inv);
+    return BigInteger(std::move(result), POSITIVE);
+}
+
+// Window width that minimizes squarings plus multiplications for an exponent of this many bits
+size_t BigInteger::windowSize(size_t bits) {
+    return bits <= 16 ? 1 : bits <= 96 ? 3 : bits <= 384 ? 4 : bits <= 1536 ? 5 : 6;
+}
+
+// Left-to-right sliding window: the exponent is split into windows of at most windowSize bits
+// that start and end with a one, each costing one multiplication by a precomputed odd power.
+// exp must be nonzero; square and multiply may reduce their results modulo something.
+template <class Square, class Multiply>
+limb_vector BigInteger::slidingWindowPow(const limb_vector& base, const limb_vector& exp,
+                                         Square square, Multiply multiply) {
+    size_t bits = bitLength(exp);
+    auto bit = [&exp](size_t i) {return (exp[i / 64] >> (i % 64)) & 1;};
+    size_t window = windowSize(bits);
+    // odd[i] = base^(2i + 1)
+    std::vector<limb_vector> odd(1, base);
+    if (window > 1) {
+        limb_vector base_square = square(base);
+        for (size_t i = 1; i < (static_cast<size_t>(1) << (window - 1)); ++i) {
+            odd.push_back(multiply(odd.back(), base_square));
+        }
+    }
+    limb_vector result;
+    bool first = true;
+    for (size_t i = bits; i > 0;) {
+        if (!bit(i - 1)) {
+            result = square(result);
+            --i;
+            continue;
+        }
+        size_t low = i > window ? i - window : 0;
+        while (!bit(low)) {
+            ++low;
+        }
+        size_t value = 0;
+        for (size_t j = i; j > low;) {
+            --j;
+            value = 2 * value + bit(j);
+        }
+        if (first) {
+            result = odd[value / 2];
+            first = false;
+        }
+        else {
+            for (size_t j = low; j < i; ++j) {
+                result = square(result);
+            }
+            result = multiply(result, odd[value / 2]);
+        }
+        i = low;
+    }
+    return result;
+}
+
+// T = T * 2^(-64n) mod m for T < m * 2^(64n), n the limb count of the odd modulus m: each round
+// adds the multiple of m that clears the lowest limb left, then the low n limbs are dropped.
+void BigInteger::montgomeryReduce(limb_vector& T, const limb_vector& mod, limb neg_inv) {
+    const size_t n = mod.size();
+    T.resize(2 * n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        limb carry = mulAddRow(T.data() + i, mod.data(), n, T[i] * neg_inv);
+        addTo(T.data() + i + n, n + 1 - i, &carry, 1);
+    }
+    T.erase(T.begin(), T.begin() + n);
+    trimVec(T);
+    if (cmpVec(T, mod) >= 0) {
+        subVec(T, mod);
+        trimVec(T);
+    }
+}
+
+// _____________________________________ROOTS_____________________________________
+BigInteger isqrt(const BigInteger& num) {
+    return iroot(num, 2);
+}
+
+BigInteger iroot(const BigInteger& num, unsigned k) {
+    if (k == 1 || num._sign == ZERO) {
+        return num;
+    }
+    BigInteger root = BigInteger::rootMagnitude(abs(num), k);
+    if (num._sign == NEGATIVE) {
+        root.Negate();
+    }
+    return root;
+}
+
+// floor(num^(1/k)) for num > 0 by precision doubling: the root of num with the low k * drop bits
+// cut off is the root to within 2^drop, and a single Newton step x = ((k - 1) x + num / x^(k - 1)) / k
+// brings that to within one, as long as drop leaves a margin of 2 + log2(k) bits below the half.
+// Roots of at most 40 bits start from a double instead. Each level costs a few multiplications
+// and one division of the full size, so the whole is as fast as the multiplication below it.
+BigInteger BigInteger::rootMagnitude(const BigInteger& num, unsigned k) {
+    size_t bits = bitLength(num._bits);
+    size_t root_bits = (bits - 1) / k + 1;
+    BigInteger root;
+    if (root_bits <= 40) {
+        size_t drop = bits > 64 ? bits - 64 : 0;
+        limb_vector top = num._bits;
+        shiftRight(top, drop);
+        double log_num = static_cast<double>(drop) + std::log2(static_cast<double>(top[0]));
+        root = BigInteger(limb_vector(1, static_cast<limb>(std::exp2(log_num / k))), POSITIVE);
+    }
+    else {
+        size_t margin = 2 + static_cast<size_t>(std::ceil(std::log2(static_cast<double>(k))));
+        size_t drop = root_bits / 2 > margin + 1 ? root_bits / 2 - margin : 1;
+        limb_vector high = num._bits;
+        shiftRight(high, k * drop);
+        BigInteger guess = rootMagnitude(BigInteger(std::move(high), POSITIVE), k);
+        shiftLeft(guess._bits, drop);
+        root = num / (k == 2 ? guess : pow(guess, k - 1));
+        mulSmall(guess._bits, k - 1);
+        root += guess;
+        divSmall(root._bits, k);
+    }
+    // Newton's step from either side lands at or just above the root, the double within one of it
+    while (pow(root, k) > num) {
+        --root;
+    }
+    BigInteger next = root;
+    ++next;
+    while (pow(next, k) <= num) {
+        root = next;
+        ++next;
+    }
+    return root;
+}
+
+// _____________________________________GREATEST_COMMON_DIVISOR_____________________________________
+BigInteger GreatestCommonDivisor(BigInteger a, BigInteger b) {
+    a = abs(std::move(a));
+    b = abs(std::move(b));
+    if (a < b) {
+        std::swap(a, b);
+    }
+    BigInteger::hgcdReduce(a, b, 1, nullptr);
+    if (!b) {
+        return a;
+    }
+    // Both fit in a limb now: finish with the binary algorithm
+    limb u = b._bits[0];
+    limb v = BigInteger::divSmall(a._bits, u);
+    if (v == 0) {
+        return b;
+    }
+    int shift = __builtin_ctzll(u | v);
+    u >>= __builtin_ctzll(u);
+    while (v) {
+        v >>= __builtin_ctzll(v);
+        if (u > v) {
+            std::swap(u, v);
+        }
+        v -= u;
+    }
+    return BigInteger(limb_vector(1, u << shift), POSITIVE);
+}
+
+BigInteger ExtendedGreatestCommonDivisor(const BigInteger& a, const BigInteger& b,
+                                         BigInteger& x, BigInteger& y) {
+    BigInteger u = abs(a);
+    BigInteger v = abs(b);
+    bool swapped = u < v;
+    if (swapped) {
+        std::swap(u, v);
+    }
+    BigInteger::GcdMatrix matrix;
+    BigInteger::hgcdReduce(u, v, 0, &matrix);
+    // (|a|; |b|) = M (g; 0) and M^-1 = det * (m11, -m01; -m10, m00), so g = det * (m11 |a| - m01 |b|)
+    BigInteger coef_a = matrix.m[3];
+    BigInteger coef_b = -matrix.m[1];
+    if (matrix.det < 0) {
+        coef_a.Negate();
+        coef_b.Negate();
+    }
+    if (swapped) {
+        std::swap(coef_a, coef_b);
+    }
+    if (a._sign == NEGATIVE) {
+        coef_a.Negate();
+    }
+    if (b._sign == NEGATIVE) {
+        coef_b.Negate();
+    }
+    x = coef_a;
+    y = coef_b;
+    return u;
+}
+
+// Reduces a >= b >= 0 by steps of the Euclidean algorithm until b has at most `stop` limbs.
+// Removing d limbs only depends on the top 2d limbs or so, hence for large d the quotients of
+// the first d/2 limbs are found recursively on the top part (plus two guard limbs) and applied
+// to the full numbers as one matrix product. The result is checked, so a matrix that the
+// truncation made wrong is replaced by a plain division step.
+void BigInteger::hgcdReduce(BigInteger& a, BigInteger& b, size_t stop, GcdMatrix* matrix) {
+    while (b._sign != ZERO && b._bits.size() > stop) {
+        size_t d = a._bits.size() - stop;
+        if (d < _hgcd_threshold || a._bits.size() > b._bits.size() + 1) {
+            if (!lehmerStep(a, b, matrix)) {
+                divisionStep(a, b, matrix);
+            }
+            continue;
+        }
+        size_t h = d / 2;
+        if (a._bits.size() <= 2 * h + 2) {
+            hgcdReduce(a, b, a._bits.size() - h, matrix);
+            continue;
+        }
+        size_t p = a._bits.size() - 2 * h - 2;
+        BigInteger a_top(limb_vector(a._bits.begin() + p, a._bits.end()), POSITIVE);
+        BigInteger b_top(limb_vector(b._bits.begin() + p, b._bits.end()), POSITIVE);
+        GcdMatrix step;
+        hgcdReduce(a_top, b_top, a_top._bits.size() - h, &step);
+        if (step.isIdentity() || !applyMatrix(a, b, step)) {
+            divisionStep(a, b, matrix);
+            continue;
+        }
+        if (matrix) {
+            matrix->multiply(step);
+        }
+    }
+}
+
+// Lehmer's step (Knuth 4.5.2, algorithm L): runs Euclid on the leading 63 bits of a and the
+// bits of b at the same position, as long as both ends of the truncation interval agree on the
+// quotient, then applies the cofactors (A B; C D) to the full numbers in one pass.
+bool BigInteger::lehmerStep(BigInteger& a, BigInteger& b, GcdMatrix* matrix) {
+    size_t n = a._bits.size();
+    if (b._bits.size() + 1 < n) {
+        return false;
+    }
+    size_t bits = 64 * (n - 1) + static_cast<size_t>(64 - __builtin_clzll(a._bits[n - 1]));
+    if (bits <= 63) {
+        return false;
+    }
+    size_t offset = bits - 63;
+    size_t index = offset / 64;
+    int shift = static_cast<int>(offset % 64);
+    auto leading = [index, shift](const limb_vector& vec) {
+        limb low = index < vec.size() ? vec[index] >> shift : 0;
+        limb high = shift && index + 1 < vec.size() ? vec[index + 1] << (64 - shift) : 0;
+        return static_cast<__int128>(low | high);
+    };
+    __int128 x = leading(a._bits);
+    __int128 y = leading(b._bits);
+    __int128 A = 1, B = 0, C = 0, D = 1;
+    while (y + C > 0 && y + D > 0 && x + A >= 0 && x + B >= 0) {
+        __int128 q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D)) {
+            break;
+        }
+        __int128 t = A - q * C;
+        A = C;
+        C = t;
+        t = B - q * D;
+        B = D;
+        D = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+    }
+    if (B == 0) {
+        return false;
+    }
+    // Rows of a Lehmer matrix have opposite signs and the new values are nonnegative
+    auto combine = [](const limb_vector& u, __int128 x_coef, const limb_vector& v, __int128 y_coef) {
+        return y_coef <= 0 ? mulSubSmall(u, static_cast<limb>(x_coef), v, static_cast<limb>(-y_coef))
+                           : mulSubSmall(v, static_cast<limb>(y_coef), u, static_cast<limb>(-x_coef));
+    };
+    limb_vector new_a = combine(a._bits, A, b._bits, B);
+    limb_vector new_b = combine(a._bits, C, b._bits, D);
+    a = BigInteger(std::move(new_a), POSITIVE);
+    b = BigInteger(std::move(new_b), POSITIVE);
+    if (matrix) {
+        // (A B; C D)^-1 = det * (D -B; -C A), which has nonnegative entries
+        int det = A * D - B * C > 0 ? 1 : -1;
+        auto entry = [det](__int128 value) {return static_cast<limb>(det > 0 ? value : -value);};
+        matrix->multiplySmall(entry(D), entry(-B), entry(-C), entry(A), det);
+    }
+    return true;
+}
+
+void BigInteger::divisionStep(BigInteger& a, BigInteger& b, GcdMatrix* matrix) {
+    BigInteger remainder;
+    a.divmod(b, remainder);
+    if (matrix) {
+        GcdMatrix step;
+        step.m[0] = a;
+        step.m[1] = 1;
+        step.m[2] = 1;
+        step.m[3] = 0;
+        step.det = -1;
+        matrix->multiply(step);
+    }
+    std::swap(a, b);
+    b = remainder;
+}
+
+// (a; b) = step^-1 (a; b) if that keeps a > b >= 0
+bool BigInteger::applyMatrix(BigInteger& a, BigInteger& b, const GcdMatrix& step) {
+    BigInteger new_a = step.m[3] * a - step.m[1] * b;
+    BigInteger new_b = step.m[0] * b - step.m[2] * a;
+    if (step.det < 0) {
+        new_a.Negate();
+        new_b.Negate();
+    }
+    if (new_b < 0 || new_a <= new_b) {
+        return false;
+    }
+    a = new_a;
+    b = new_b;
+    return true;
+}
+
+// u * x + v * y
+limb_vector BigInteger::mulAddSmall(const limb_vector& u, limb x, const limb_vector& v, limb y) {
+    size_t n = std::max(u.size(), v.size());
+    limb_vector result(n + 1);
+    limb carry_u = 0, carry_v = 0, cashe = 0;
+    for (size_t i = 0; i <= n; ++i) {
+        dlimb pu = static_cast<dlimb>(i < u.size() ? u[i] : 0) * x + carry_u;
+        dlimb pv = static_cast<dlimb>(i < v.size() ? v[i] : 0) * y + carry_v;
+        carry_u = static_cast<limb>(pu >> 64);
+        carry_v = static_cast<limb>(pv >> 64);
+        limb sum = static_cast<limb>(pu) + static_cast<limb>(pv);
+        limb carry = sum < static_cast<limb>(pv);
+        result[i] = sum + cashe;
+        cashe = carry | (result[i] < sum);
+    }
+    if (carry_u || carry_v || cashe) {
+        result.push_back(carry_u + carry_v + cashe);
+    }
+    trimVec(result);
+    return result;
+}
+
+// u * x - v * y, the caller guarantees u * x >= v * y
+limb_vector BigInteger::mulSubSmall(const limb_vector& u, limb x, const limb_vector& v, limb y) {
+    size_t n = std::max(u.size(), v.size());
+    limb_vector result(n + 1);
+    limb carry_u = 0, carry_v = 0, borrow = 0;
+    for (size_t i = 0; i <= n; ++i) {
+        dlimb pu = static_cast<dlimb>(i < u.size() ? u[i] : 0) * x + carry_u;
+        dlimb pv = static_cast<dlimb>(i < v.size() ? v[i] : 0) * y + carry_v;
+        carry_u = static_cast<limb>(pu >> 64);
+        carry_v = static_cast<limb>(pv >> 64);
+        limb diff = static_cast<limb>(pu) - static_cast<limb>(pv);
+        limb under = static_cast<limb>(pu) < static_cast<limb>(pv);
+        result[i] = diff - borrow;
+        borrow = under | (diff < borrow);
+    }
+    trimVec(result);
+    return result;
+}
+
+BigInteger::GcdMatrix::GcdMatrix() : m{1, 0, 0, 1}, det(1) {}
+
+bool BigInteger::GcdMatrix::isIdentity() const {
+    return m[1]._sign == ZERO && m[2]._sign == ZERO && m[0] == 1 && m[3] == 1;
+}
+
+void BigInteger::GcdMatrix::multiply(const GcdMatrix& rhs) {
+    BigInteger m00 = m[0] * rhs.m[0] + m[1] * rhs.m[2];
+    BigInteger m01 = m[0] * rhs.m[1] + m[1] * rhs.m[3];
+    BigInteger m10 = m[2] * rhs.m[0] + m[3] * rhs.m[2];
+    BigInteger m11 = m[2] * rhs.m[1] + m[3] * rhs.m[3];
+    m[0] = m00;
+    m[1] = m01;
+    m[2] = m10;
+    m[3] = m11;
+    det *= rhs.det;
+}
+
+void BigInteger::GcdMatrix::multiplySmall(limb n00, limb n01, limb n10, limb n11, int rhs_det) {
+    BigInteger m00(mulAddSmall(m[0]._bits, n00, m[1]._bits, n10), POSITIVE);
+    BigInteger m01(mulAddSmall(m[0]._bits, n01, m[1]._bits, n11), POSITIVE);
+    BigInteger m10(mulAddSmall(m[2]._bits, n00, m[3]._bits, n10), POSITIVE);
+    BigInteger m11(mulAddSmall(m[2]._bits, n01, m[3]._bits, n11), POSITIVE);
+    m[0] = m00;
+    m[1] = m01;
+    m[2] = m10;
+    m[3] = m11;
+    det *= rhs_det;
+}
+
+// _____________________________________EXPRESSION_TEMPLATES_____________________________________
+// Opt-in lazy arithmetic: lazy(a) * b + lazy(c) * d - e only records the expression tree, and
+// assigning it to a BigInteger sums every plain term in one carry pass and multiplies the products
+// straight into the result. The tree keeps references to its operands, so evaluate it within the
+// statement that builds it.
+
+// The flattened expression: a signed list of plain terms and of products
+class BigIntegerTerms {
+public:
+    void addLeaf(const BigInteger& value, int sign);
+    void addProduct(const BigInteger& lhs, const BigInteger& rhs, int sign);
+    // Stores the value of a subexpression that has to exist before it is multiplied
+    const BigInteger& keep(BigInteger&& value);
+    void evaluate(BigInteger& result) const;
+
+private:
+    struct Term {
+        const BigInteger* lhs;
+        const BigInteger* rhs;
+        int sign;
+    };
+    std::vector<Term> _leaves;
+    std::vector<Term> _products;
+    std::forward_list<BigInteger> _temporaries;
+};
+
+template <class Expr>
+class BigIntegerExpr {
+public:
+    const Expr& self() const {return static_cast<const Expr&>(*this);}
+};
+
+class BigIntegerLeaf : public BigIntegerExpr<BigIntegerLeaf> {
+public:
+    explicit BigIntegerLeaf(const BigInteger& value) : _value(value) {}
+    void collect(BigIntegerTerms& terms, int sign) const {terms.addLeaf(_value, sign);}
+    const BigInteger& materialize(BigIntegerTerms&) const {return _value;}
+
+private:
+    const BigInteger& _value;
+};
+
+template <class L, class R>
+class BigIntegerSum : public BigIntegerExpr<BigIntegerSum<L, R>> {
+public:
+    BigIntegerSum(const L& lhs, const R& rhs, int rhs_sign) : _lhs(lhs), _rhs(rhs), _rhs_sign(rhs_sign) {}
+    void collect(BigIntegerTerms& terms, int sign) const {
+        _lhs.collect(terms, sign);
+        _rhs.collect(terms, sign * _rhs_sign);
+    }
+    const BigInteger& materialize(BigIntegerTerms& terms) const {return terms.keep(BigInteger(*this));}
+
+private:
+    L _lhs;
+    R _rhs;
+    int _rhs_sign;
+};
+
+template <class L, class R>
+class BigIntegerProduct : public BigIntegerExpr<BigIntegerProduct<L, R>> {
+public:
+    BigIntegerProduct(const L& lhs, const R& rhs) : _lhs(lhs), _rhs(rhs) {}
+    void collect(BigIntegerTerms& terms, int sign) const {
+        terms.addProduct(_lhs.materialize(terms), _rhs.materialize(terms), sign);
+    }
+    const BigInteger& materialize(BigIntegerTerms& terms) const {return terms.keep(BigInteger(*this));}
+
+private:
+    L _lhs;
+    R _rhs;
+};
+
+BigIntegerLeaf lazy(const BigInteger& value) {
+    return BigIntegerLeaf(value);
+}
+
+template <class L, class R>
+BigIntegerSum<L, R> operator + (const BigIntegerExpr<L>& lhs, const BigIntegerExpr<R>& rhs) {
+    return BigIntegerSum<L, R>(lhs.self(), rhs.self(), 1);
+}
+
+template <class L>
+BigIntegerSum<L, BigIntegerLeaf> operator + (const BigIntegerExpr<L>& lhs, const BigInteger& rhs) {
+    return BigIntegerSum<L, BigIntegerLeaf>(lhs.self(), BigIntegerLeaf(rhs), 1);
+}
+
+template <class R>
+BigIntegerSum<BigIntegerLeaf, R> operator + (const BigInteger& lhs, const BigIntegerExpr<R>& rhs) {
+    return BigIntegerSum<BigIntegerLeaf, R>(BigIntegerLeaf(lhs), rhs.self(), 1);
+}
+
+template <class L, class R>
+BigIntegerSum<L, R> operator - (const BigIntegerExpr<L>& lhs, const BigIntegerExpr<R>& rhs) {
+    return BigIntegerSum<L, R>(lhs.self(), rhs.self(), -1);
+}
+
+template <class L>
+BigIntegerSum<L, BigIntegerLeaf> operator - (const BigIntegerExpr<L>& lhs, const BigInteger& rhs) {
+    return BigIntegerSum<L, BigIntegerLeaf>(lhs.self(), BigIntegerLeaf(rhs), -1);
+}
+
+template <class R>
+BigIntegerSum<BigIntegerLeaf, R> operator - (const BigInteger& lhs, const BigIntegerExpr<R>& rhs) {
+    return BigIntegerSum<BigIntegerLeaf, R>(BigIntegerLeaf(lhs), rhs.self(), -1);
+}
+
+template <class L, class R>
+BigIntegerProduct<L, R> operator * (const BigIntegerExpr<L>& lhs, const BigIntegerExpr<R>& rhs) {
+    return BigIntegerProduct<L, R>(lhs.self(), rhs.self());
+}
+
+template <class L>
+BigIntegerProduct<L, BigIntegerLeaf> operator * (const BigIntegerExpr<L>& lhs, const BigInteger& rhs) {
+    return BigIntegerProduct<L, BigIntegerLeaf>(lhs.self(), BigIntegerLeaf(rhs));
+}
+
+template <class R>
+BigIntegerProduct<BigIntegerLeaf, R> operator * (const BigInteger& lhs, const BigIntegerExpr<R>& rhs) {
+    return BigIntegerProduct<BigIntegerLeaf, R>(BigIntegerLeaf(lhs), rhs.self());
+}
+
+template <class Expr>
+BigInteger::BigInteger(const BigIntegerExpr<Expr>& expr) : BigInteger() {
+    *this = expr;
+}
+
+template <class Expr>
+BigInteger& BigInteger::operator = (const BigIntegerExpr<Expr>& expr) {
+    BigIntegerTerms terms;
+    expr.self().collect(terms, 1);
+    terms.evaluate(*this);
+    return *this;
+}
+
+void BigIntegerTerms::addLeaf(const BigInteger& value, int sign) {
+    if (value._sign != ZERO) {
+        _leaves.push_back(Term{&value, nullptr, sign * value._sign});
+    }
+}
+
+void BigIntegerTerms::addProduct(const BigInteger& lhs, const BigInteger& rhs, int sign) {
+    if (lhs._sign != ZERO && rhs._sign != ZERO) {
+        _products.push_back(Term{&lhs, &rhs, sign * lhs._sign * rhs._sign});
+    }
+}
+
+const BigInteger& BigIntegerTerms::keep(BigInteger&& value) {
+    _temporaries.push_front(std::move(value));
+    return _temporaries.front();
+}
+
+// The result is accumulated in two's complement one limb wider than the largest term, which holds
+// any signed sum of fewer than 2^63 terms. It is built in result's own buffer unless result is
+// also an operand.
+void BigIntegerTerms::evaluate(BigInteger& result) const {
+    size_t width = 0;
+    bool aliased = false;
+    for (const Term& term : _leaves) {
+        width = std::max(width, term.lhs->_bits.size());
+        aliased |= term.lhs == &result;
+    }
+    for (const Term& term : _products) {
+        width = std::max(width, term.lhs->_bits.size() + term.rhs->_bits.size());
+        aliased |= term.lhs == &result || term.rhs == &result;
+    }
+    if (width == 0) {
+        result = BigInteger();
+        return;
+    }
+    ++width;
+    limb_vector local;
+    limb_vector& acc = aliased ? local : result._bits;
+    acc.resize(width);
+
+    // All plain terms in one pass; the signed 128-bit column sum cannot overflow
+    __int128 cashe = 0;
+    for (size_t i = 0; i < width; ++i) {
+        __int128 column = cashe;
+        for (const Term& term : _leaves) {
+            if (i < term.lhs->_bits.size()) {
+                __int128 digit = term.lhs->_bits[i];
+                column += term.sign > 0 ? digit : -digit;
+            }
+        }
+        acc[i] = static_cast<limb>(column);
+        cashe = column >> 64;
+    }
+
+    // Products below the Karatsuba size go row by row into acc, larger ones are added once formed
+    for (const Term& term : _products) {
+        const limb_vector& A = term.lhs->_bits.size() >= term.rhs->_bits.size() ? term.lhs->_bits : term.rhs->_bits;
+        const limb_vector& B = &A == &term.lhs->_bits ? term.rhs->_bits : term.lhs->_bits;
+        if (B.size() < BigInteger::_karatsuba_threshold) {
+            for (size_t i = 0; i < B.size(); ++i) {
+                limb* row = acc.data() + i;
+                if (term.sign > 0) {
+                    limb carry = BigInteger::mulAddRow(row, A.data(), A.size(), B[i]);
+                    BigInteger::addTo(row + A.size(), width - i - A.size(), &carry, 1);
+                }
+                else {
+                    limb borrow = BigInteger::mulSubRow(row, A.data(), A.size(), B[i]);
+                    BigInteger::subFrom(row + A.size(), width - i - A.size(), &borrow, 1);
+                }
+            }
+        }
+        else {
+            limb_vector product = BigInteger::mulVec(A, B);
+            if (term.sign > 0) {
+                BigInteger::addTo(acc.data(), width, product.data(), product.size());
+            }
+            else {
+                BigInteger::subFrom(acc.data(), width, product.data(), product.size());
+            }
+        }
+    }
+
+    Sign sign = POSITIVE;
+    if (acc.back() >> 63) {
+        sign = NEGATIVE;
+        limb cashe = 1;
+        for (size_t i = 0; i < width; ++i) {
+            acc[i] = ~acc[i] + cashe;
+            cashe = cashe && acc[i] == 0;
+        }
+    }
+    BigInteger::trimVec(acc);
+    if (acc.size() == 1 && acc[0] == 0) {
+        sign = ZERO;
+    }
+    if (aliased) {
+        result._bits.swap(local);
+    }
+    result._sign = sign;
+}
+
+// _____________________________________FIXED_WIDTH_____________________________________
+// A two's complement integer of Bits bits held in place, for values with a known bound. Arithmetic
+// wraps modulo 2^Bits like the built-in signed types do in practice, and every operation except
+// division and conversion is constexpr over a fixed number of limbs the compiler unrolls.
+// Division follows BigInteger: the quotient rounds toward zero, the remainder takes the dividend's sign.
+template <size_t Bits>
+class FixedBigInt {
+    static_assert(Bits > 0 && Bits % 64 == 0, "FixedBigInt width must be a positive multiple of 64 bits");
+public:
+    static constexpr size_t limbs = Bits / 64;
+
+    constexpr FixedBigInt() : _limbs{} {}
+    constexpr FixedBigInt(long long num) : _limbs{} {
+        for (size_t i = 1; i < limbs; ++i) {
+            _limbs[i] = num < 0 ? ~static_cast<limb>(0) : 0;
+        }
+        _limbs[0] = static_cast<limb>(num);
+    }
+    // Keeps num modulo 2^Bits
+    explicit FixedBigInt(const BigInteger& num);
+    std::string toString() const {return BigInteger(*this).toString();}
+
+    constexpr const limb* data() const {return _limbs;}
+    constexpr bool isNegative() const {return _limbs[limbs - 1] >> 63;}
+    constexpr explicit operator bool() const {
+        limb any = 0;
+        for (size_t i = 0; i < limbs; ++i) {
+            any |= _limbs[i];
+        }
+        return any != 0;
+    }
+
+    constexpr FixedBigInt& operator += (const FixedBigInt& rhs) {
+        limb cashe = 0;
+        BIGINTEGER_UNROLL
+        for (size_t i = 0; i < limbs; ++i) {
+            dlimb sum = static_cast<dlimb>(_limbs[i]) + rhs._limbs[i] + cashe;
+            _limbs[i] = static_cast<limb>(sum);
+            cashe = static_cast<limb>(sum >> 64);
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator -= (const FixedBigInt& rhs) {
+        limb borrow = 0;
+        BIGINTEGER_UNROLL
+        for (size_t i = 0; i < limbs; ++i) {
+            dlimb diff = static_cast<dlimb>(_limbs[i]) - rhs._limbs[i] - borrow;
+            _limbs[i] = static_cast<limb>(diff);
+            borrow = static_cast<limb>(diff >> 64) & 1;
+        }
+        return *this;
+    }
+    // Schoolbook, keeping only the limbs below 2^Bits; in two's complement those do not depend on signs
+    constexpr FixedBigInt& operator *= (const FixedBigInt& rhs) {
+        limb result[limbs] = {};
+        BIGINTEGER_UNROLL
+        for (size_t i = 0; i < limbs; ++i) {
+            limb cashe = 0;
+            BIGINTEGER_UNROLL
+            for (size_t j = 0; i + j < limbs; ++j) {
+                dlimb cur = static_cast<dlimb>(_limbs[i]) * rhs._limbs[j] + result[i + j] + cashe;
+                result[i + j] = static_cast<limb>(cur);
+                cashe = static_cast<limb>(cur >> 64);
+            }
+        }
+        BIGINTEGER_UNROLL
+        for (size_t i = 0; i < limbs; ++i) {
+            _limbs[i] = result[i];
+        }
+        return *this;
+    }
+    FixedBigInt& operator /= (const FixedBigInt& rhs) {
+        FixedBigInt remainder;
+        divmod(*this, rhs, *this, remainder);
+        return *this;
+    }
+    FixedBigInt& operator %= (const FixedBigInt& rhs) {
+        FixedBigInt quotient;
+        divmod(*this, rhs, quotient, *this);
+        return *this;
+    }
+    constexpr FixedBigInt& operator &= (const FixedBigInt& rhs) {
+        for (size_t i = 0; i < limbs; ++i) {
+            _limbs[i] &= rhs._limbs[i];
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator |= (const FixedBigInt& rhs) {
+        for (size_t i = 0; i < limbs; ++i) {
+            _limbs[i] |= rhs._limbs[i];
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator ^= (const FixedBigInt& rhs) {
+        for (size_t i = 0; i < limbs; ++i) {
+            _limbs[i] ^= rhs._limbs[i];
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator <<= (size_t shift) {
+        size_t whole = shift / 64;
+        int bits = static_cast<int>(shift % 64);
+        for (size_t i = limbs; i > 0;) {
+            --i;
+            limb value = i >= whole ? _limbs[i - whole] << bits : 0;
+            if (bits && i > whole) {
+                value |= _limbs[i - whole - 1] >> (64 - bits);
+            }
+            _limbs[i] = value;
+        }
+        return *this;
+    }
+    // Arithmetic: the sign is shifted in, so negatives round toward minus infinity
+    constexpr FixedBigInt& operator >>= (size_t shift) {
+        limb fill = isNegative() ? ~static_cast<limb>(0) : 0;
+        size_t whole = shift / 64;
+        int bits = static_cast<int>(shift % 64);
+        for (size_t i = 0; i < limbs; ++i) {
+            limb low = i + whole < limbs ? _limbs[i + whole] : fill;
+            limb high = i + whole + 1 < limbs ? _limbs[i + whole + 1] : fill;
+            _limbs[i] = bits ? (low >> bits) | (high << (64 - bits)) : low;
+        }
+        return *this;
+    }
+    constexpr FixedBigInt& operator ++ () {
+        for (size_t i = 0; i < limbs && ++_limbs[i] == 0; ++i) {}
+        return *this;
+    }
+    constexpr FixedBigInt& operator -- () {
+        for (size_t i = 0; i < limbs && _limbs[i]-- == 0; ++i) {}
+        return *this;
+    }
+    constexpr FixedBigInt operator ++ (int) {
+        FixedBigInt tmp(*this);
+        ++*this;
+        return tmp;
+    }
+    constexpr FixedBigInt operator -- (int) {
+        FixedBigInt tmp(*this);
+        --*this;
+        return tmp;
+    }
+    constexpr FixedBigInt operator ~ () const {
+        FixedBigInt result;
+        for (size_t i = 0; i < limbs; ++i) {
+            result._limbs[i] = ~_limbs[i];
+        }
+        return result;
+    }
+    constexpr FixedBigInt operator - () const {
+        FixedBigInt result = ~*this;
+        return ++result;
+    }
+
+    friend constexpr FixedBigInt operator + (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs += rhs;}
+    friend constexpr FixedBigInt operator - (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs -= rhs;}
+    friend constexpr FixedBigInt operator * (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs *= rhs;}
+    friend FixedBigInt operator / (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs /= rhs;}
+    friend FixedBigInt operator % (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs %= rhs;}
+    friend constexpr FixedBigInt operator & (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs &= rhs;}
+    friend constexpr FixedBigInt operator | (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs |= rhs;}
+    friend constexpr FixedBigInt operator ^ (FixedBigInt lhs, const FixedBigInt& rhs) {return lhs ^= rhs;}
+    friend constexpr FixedBigInt operator << (FixedBigInt lhs, size_t shift) {return lhs <<= shift;}
+    friend constexpr FixedBigInt operator >> (FixedBigInt lhs, size_t shift) {return lhs >>= shift;}
+    friend constexpr FixedBigInt abs(const FixedBigInt& num) {return num.isNegative() ? -num : num;}
+
+    friend constexpr bool operator == (const FixedBigInt& lhs, const FixedBigInt& rhs) {
+        limb diff = 0;
+        BIGINTEGER_UNROLL
+        for (size_t i = 0; i < limbs; ++i) {
+            diff |= lhs._limbs[i] ^ rhs._limbs[i];
+        }
+        return diff == 0;
+    }
+    friend constexpr bool operator != (const FixedBigInt& lhs, const FixedBigInt& rhs) {return !(lhs == rhs);}
+    // Flipping the sign bits turns the signed order into the unsigned one
+    friend constexpr bool operator < (const FixedBigInt& lhs, const FixedBigInt& rhs) {
+        const limb flip = static_cast<limb>(1) << 63;
+        if (lhs._limbs[limbs - 1] != rhs._limbs[limbs - 1]) {
+            return (lhs._limbs[limbs - 1] ^ flip) < (rhs._limbs[limbs - 1] ^ flip);
+        }
+        BIGINTEGER_UNROLL
+        for (size_t i = limbs - 1; i > 0;) {
+            --i;
+            if (lhs._limbs[i] != rhs._limbs[i]) {
+                return lhs._limbs[i] < rhs._limbs[i];
+            }
+        }
+        return false;
+    }
+    friend constexpr bool operator > (const FixedBigInt& lhs, const FixedBigInt& rhs) {return rhs < lhs;}
+    friend constexpr bool operator <= (const FixedBigInt& lhs, const FixedBigInt& rhs) {return !(rhs < lhs);}
+    friend constexpr bool operator >= (const FixedBigInt& lhs, const FixedBigInt& rhs) {return !(lhs < rhs);}
+
+    friend std::ostream& operator << (std::ostream& stream, const FixedBigInt& num) {
+        return stream << BigInteger(num);
+    }
+    friend std::istream& operator >> (std::istream& stream, FixedBigInt& num) {
+        BigInteger value;
+        stream >> value;
+        num = FixedBigInt(value);
+        return stream;
+    }
+
+    static void divmod(const FixedBigInt& dividend, const FixedBigInt& divisor,
+                       FixedBigInt& quotient, FixedBigInt& remainder);
+
+private:
+    limb _limbs[limbs];
+};
+
+template <size_t Bits>
+BigInteger::BigInteger(const FixedBigInt<Bits>& num) : _sign(POSITIVE),
+                                                       _bits(num.data(), num.data() + FixedBigInt<Bits>::limbs) {
+    if (num.isNegative()) {
+        limb cashe = 1;
+        for (size_t i = 0; i < _bits.size(); ++i) {
+            _bits[i] = ~_bits[i] + cashe;
+            cashe &= _bits[i] == 0;
+        }
+        _sign = NEGATIVE;
+    }
+    rmInsignNulls();
+    if (_bits.size() == 1 && _bits[0] == 0) {
+        _sign = ZERO;
     }
-    return lhs._bits == rhs._bits;
 }
 
-bool operator != (const BigInteger& lhs, const BigInteger& rhs) {
-    return !(lhs == rhs);
+template <size_t Bits>
+FixedBigInt<Bits>::FixedBigInt(const BigInteger& num) : _limbs{} {
+    for (size_t i = 0; i < limbs && i < num._bits.size(); ++i) {
+        _limbs[i] = num._bits[i];
+    }
+    if (num._sign == NEGATIVE) {
+        *this = -*this;
+    }
 }
 
-bool operator < (const BigInteger& lhs, const BigInteger& rhs) {
-    if (lhs._sign != rhs._sign) {
-        return lhs._sign < rhs._sign;
+// On the magnitudes: short division by a one-limb divisor, BigInteger's algorithm D otherwise
+template <size_t Bits>
+void FixedBigInt<Bits>::divmod(const FixedBigInt& dividend, const FixedBigInt& divisor,
+                               FixedBigInt& quotient, FixedBigInt& remainder) {
+    bool dividend_negative = dividend.isNegative();
+    bool quotient_negative = dividend_negative != divisor.isNegative();
+    FixedBigInt a = dividend_negative ? -dividend : dividend;
+    FixedBigInt b = divisor.isNegative() ? -divisor : divisor;
+    size_t a_size = limbs;
+    size_t b_size = limbs;
+    while (a_size > 1 && a._limbs[a_size - 1] == 0) {
+        --a_size;
     }
-    if (lhs.size != rhs.size) {
-        return lhs._sign == POSITIVE ? lhs.size < rhs.size : rhs.size < lhs.size;
+    while (b_size > 1 && b._limbs[b_size - 1] == 0) {
+        --b_size;
     }
-    for (size_t i = lhs.size; i > 0;) {
-        --i;
-        if (lhs._bits[i] == rhs._bits[i]) {
-            continue;
+    FixedBigInt q;
+    FixedBigInt r;
+    if (a_size < b_size) {
+        r = a;
+    }
+    else if (b_size == 1) {
+        dlimb cashe = 0;
+        for (size_t i = a_size; i > 0;) {
+            --i;
+            dlimb cur = (cashe << 64) | a._limbs[i];
+            q._limbs[i] = static_cast<limb>(cur / b._limbs[0]);
+            cashe = cur % b._limbs[0];
         }
-        return lhs._sign == POSITIVE ? (lhs._bits[i] < rhs._bits[i]) : !(lhs._bits[i] < rhs._bits[i]);
+        r._limbs[0] = static_cast<limb>(cashe);
     }
-    return false;
+    else {
+        BigInteger::divKnuth(a._limbs, a_size, b._limbs, b_size, q._limbs, r._limbs);
+    }
+    quotient = quotient_negative ? -q : q;
+    remainder = dividend_negative ? -r : r;
 }
 
-bool operator > (const BigInteger& lhs, const BigInteger& rhs) {
-    return (rhs < lhs);
-}
+// _____________________________________BATCH_____________________________________
+// Many independent small operations at once. Additions are done a block of _lanes operands at a
+// time in a structure-of-arrays layout: limb k of every operand sits side by side, in two's
+// complement so that signs need no branches, and one vector pass adds limb k of four operands with
+// no carry chain between them. Operands over _max_limbs limbs go through the plain operators.
+// Blocks are spread over the pool from BigInteger::setThreadPool once a batch holds at least its
+// min_limbs operations.
+class BigIntegerBatch {
+public:
+    // out[i] = lhs[i] + rhs[i] for i < count; out[i] may be lhs[i] or rhs[i] itself
+    static void add(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count);
+    static void sub(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count);
+    // Each product is written straight into out[i]'s limbs
+    static void mul(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count);
+    // out is resized to lhs.size(), which rhs must match
+    static void add(const std::vector<BigInteger>& lhs, const std::vector<BigInteger>& rhs, std::vector<BigInteger>& out);
+    static void sub(const std::vector<BigInteger>& lhs, const std::vector<BigInteger>& rhs, std::vector<BigInteger>& out);
+    static void mul(const std::vector<BigInteger>& lhs, const std::vector<BigInteger>& rhs, std::vector<BigInteger>& out);
+    // values[0] + ... + values[count - 1], every lane keeping a running sum of its own
+    static BigInteger sum(const BigInteger* values, size_t count);
+    static BigInteger sum(const std::vector<BigInteger>& values);
 
-bool operator <= (const BigInteger& lhs, const BigInteger& rhs) {
-    return !(lhs > rhs);
+private:
+    static constexpr size_t _lanes = 256;
+    static constexpr size_t _max_limbs = 16;
+
+    // result = lhs + (rhs ^ flip) + (flip & 1) lane by lane over width limbs, so flip = ~0 subtracts
+    typedef void (*LaneKernel)(limb* result, const limb* lhs, const limb* rhs, size_t width, limb flip);
+    static LaneKernel _lane_kernel;
+
+    static void addBlock(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count, bool subtract);
+    static size_t laneWidth(const BigInteger* values, size_t count);
+    static void pack(limb* lanes, const BigInteger* values, size_t count, size_t width);
+    static void unpack(BigInteger* out, const limb* lanes, size_t count, size_t width);
+    static void addLanesScalar(limb* result, const limb* lhs, const limb* rhs, size_t width, limb flip);
+#ifdef BIGINTEGER_X86_SIMD
+    static void addLanesAvx2(limb* result, const limb* lhs, const limb* rhs, size_t width, limb flip);
+#endif
+};
+
+#ifdef BIGINTEGER_X86_SIMD
+BigIntegerBatch::LaneKernel BigIntegerBatch::_lane_kernel = BigInteger::simdLevel() == 2 ? &BigIntegerBatch::addLanesAvx2
+                                                                                        : &BigIntegerBatch::addLanesScalar;
+#else
+BigIntegerBatch::LaneKernel BigIntegerBatch::_lane_kernel = &BigIntegerBatch::addLanesScalar;
+#endif
+
+void BigIntegerBatch::add(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count) {
+    BigInteger::forkEach(count, (count + _lanes - 1) / _lanes, [&](size_t block) {
+        size_t from = block * _lanes;
+        addBlock(lhs + from, rhs + from, out + from, std::min(_lanes, count - from), false);
+    });
 }
 
-bool operator >= (const BigInteger& lhs, const BigInteger& rhs) {
-    return !(lhs < rhs);
+void BigIntegerBatch::sub(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count) {
+    BigInteger::forkEach(count, (count + _lanes - 1) / _lanes, [&](size_t block) {
+        size_t from = block * _lanes;
+        addBlock(lhs + from, rhs + from, out + from, std::min(_lanes, count - from), true);
+    });
 }
 
-// _____________________________________STREAM_OPERATORS_____________________________________
-std::istream& operator >> (std::istream& stream, BigInteger& num) {
-    std::string s;
-    stream >> s;
-    num._bits.pop_back();
-    if (*s.begin() == '-') {
-        num._sign = NEGATIVE;
-        s.erase(s.begin());
-    }
-    else {
-        num._sign = POSITIVE;
-    }
-    if (s == "0") {
-        num._sign = ZERO;
-        num._bits.push_back(0);
-        num.size = 1;
-        return stream;
-    }
-    for (int pos = static_cast<int>(s.size()); pos > 0; pos -= BigInteger::_mod) {
-        if (pos < BigInteger::_mod) {
-            num._bits.push_back(stoi(s.substr(0, pos)));
-        }
-        else {
-            num._bits.push_back(stoi(s.substr(pos - BigInteger::_mod, BigInteger::_mod)));
+// Products share no carries, so they are taken one by one; short ones go by schoolbook into the
+// existing buffer of out[i], unless out[i] is also an operand
+void BigIntegerBatch::mul(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count) {
+    BigInteger::forkEach(count, (count + _lanes - 1) / _lanes, [&](size_t block) {
+        for (size_t i = block * _lanes; i < std::min(count, (block + 1) * _lanes); ++i) {
+            const limb_vector& a = lhs[i]._bits;
+            const limb_vector& b = rhs[i]._bits;
+            if (lhs[i]._sign == ZERO || rhs[i]._sign == ZERO) {
+                out[i] = BigInteger();
+            }
+            else if (&out[i] == &lhs[i] || &out[i] == &rhs[i] ||
+                     std::min(a.size(), b.size()) >= BigInteger::_karatsuba_threshold) {
+                out[i] = lhs[i] * rhs[i];
+            }
+            else {
+                out[i]._bits.resize(a.size() + b.size());
+                BigInteger::simpleMultiply(out[i]._bits.data(), a.data(), a.size(), b.data(), b.size());
+                BigInteger::trimVec(out[i]._bits);
+                out[i]._sign = lhs[i]._sign == rhs[i]._sign ? POSITIVE : NEGATIVE;
+            }
         }
-    }
-    num.size = num._bits.size();
-    return stream;
+    });
 }
 
-std::ostream& operator << (std::ostream& stream, const BigInteger& num) {
-    if (num._sign == NEGATIVE) {
-        stream << '-';
-    }
-    auto it = num._bits.rbegin();
-    stream << std::to_string(*it);
-    ++it;
-    for (; it != num._bits.rend(); ++it) {
-        size_t zero_cnt = BigInteger::_mod - std::to_string(*it).size();
-        while (zero_cnt > 0) {
-            stream << '0';
-            --zero_cnt;
-        }
-        stream << std::to_string(*it);
-    }
-    return stream;
+void BigIntegerBatch::add(const std::vector<BigInteger>& lhs, const std::vector<BigInteger>& rhs,
+                          std::vector<BigInteger>& out) {
+    out.resize(lhs.size());
+    add(lhs.data(), rhs.data(), out.data(), lhs.size());
 }
 
-std::string BigInteger::toString() const {
-    std::string s = "";
-        if (_sign == NEGATIVE) {
-            s += '-';
-    }
-    auto it = _bits.rbegin();
-    s += std::to_string(*it);
-    ++it;
-    for (; it != _bits.rend(); ++it) {
-        size_t zero_cnt = BigInteger::_mod - std::to_string(*it).size();
-        while (zero_cnt > 0) {
-            s += '0';
-            --zero_cnt;
-        }
-        s += std::to_string(*it);
-    }
-    return s;
+void BigIntegerBatch::sub(const std::vector<BigInteger>& lhs, const std::vector<BigInteger>& rhs,
+                          std::vector<BigInteger>& out) {
+    out.resize(lhs.size());
+    sub(lhs.data(), rhs.data(), out.data(), lhs.size());
 }
 
-// _____________________________________PRIVATE_METHODS_____________________________________
-void BigInteger::sumVec(std::vector<int>& lhs, const std::vector<int>& rhs) {
-    int cashe = 0;
-    for (size_t i = 0; i < std::max(lhs.size(), rhs.size()) || cashe; ++i) {
-        if (i == lhs.size()) {
-            lhs.push_back(0);
-        }
-        lhs[i] += cashe + (i < rhs.size() ? rhs[i] : 0);
-        if (lhs[i] >= _base) {
-            cashe = 1;
-            lhs[i] -= _base;
+void BigIntegerBatch::mul(const std::vector<BigInteger>& lhs, const std::vector<BigInteger>& rhs,
+                          std::vector<BigInteger>& out) {
+    out.resize(lhs.size());
+    mul(lhs.data(), rhs.data(), out.data(), lhs.size());
+}
+
+// Every block, or every thread's run of blocks, is added into lane sums one limb wider than the
+// widest operand; count is far below 2^64, so those never overflow
+BigInteger BigIntegerBatch::sum(const BigInteger* values, size_t count) {
+    size_t blocks = (count + _lanes - 1) / _lanes;
+    size_t tasks = BigInteger::parallel(count) ? std::min(blocks, static_cast<size_t>(64)) : 1;
+    std::vector<BigInteger> partial(tasks);
+    BigInteger::forkEach(count, tasks, [&](size_t task) {
+        size_t block_from = blocks * task / tasks;
+        size_t block_to = blocks * (task + 1) / tasks;
+        const BigInteger* first = values + block_from * _lanes;
+        size_t n = std::min(count, block_to * _lanes) - block_from * _lanes;
+        size_t width = laneWidth(first, n) + 1;
+        std::vector<limb> total(width * _lanes, 0);
+        std::vector<limb> lanes(width * _lanes);
+        for (size_t from = 0; from < n; from += _lanes) {
+            size_t block_count = std::min(_lanes, n - from);
+            std::fill(lanes.begin(), lanes.end(), 0);
+            pack(lanes.data(), first + from, block_count, width);
+            _lane_kernel(total.data(), total.data(), lanes.data(), width, 0);
+            for (size_t i = from; i < from + block_count; ++i) {
+                if (first[i]._bits.size() > _max_limbs) {
+                    partial[task] += first[i];
+                }
+            }
         }
-        else {
-            cashe = 0;
+        std::vector<BigInteger> lane_sums(_lanes);
+        unpack(lane_sums.data(), total.data(), _lanes, width);
+        for (const BigInteger& lane_sum : lane_sums) {
+            partial[task] += lane_sum;
         }
+    });
+    BigInteger result;
+    for (const BigInteger& value : partial) {
+        result += value;
     }
+    return result;
 }
 
-std::vector<int> BigInteger::karatsuba(std::vector<int>& A, std::vector<int>& B) {
-    size_t n = std::max(A.size(), B.size());
-    --n;
-    for (int p=1; p<32; p<<=1) n |= (n >> p);
-    ++n;
-    A.resize(n ,0);
-    B.resize(n ,0);
-
-    if (n < 2) {
-        return simpleMultiply(A, B);
-    }
-
-    size_t m = n / 2;
+BigInteger BigIntegerBatch::sum(const std::vector<BigInteger>& values) {
+    return sum(values.data(), values.size());
+}
 
-    std::vector<int> a(A.begin() + m, A.end());
-    std::vector<int> b(A.begin(), A.begin() + m);
-    std::vector<int> c(B.begin() + m, B.end());
-    std::vector<int> d(B.begin(), B.begin() + m);
-    std::vector<int> a_c = karatsuba(a, c);
-    std::vector<int> b_d = karatsuba(b, d);
-    std::vector<int> a_(a);
-    std::vector<int> c_(c);
-    sumVec(a_, b);
-    sumVec(c_, d);
-    std::vector<int> ab_cd = karatsuba(a_, c_);
-    std::vector<int> result = a_c;
-    result.insert(result.begin(), 2 * m, 0);
-    std::vector<int> tmp = ab_cd;
-    tmp.insert(tmp.begin(), m, 0);
-    sumVec(result, tmp);
-    sumVec(result, b_d);
-    std::vector<int> ac_s_bd(a_c);
-    sumVec(ac_s_bd, b_d);
-    ac_s_bd.insert(ac_s_bd.begin(), m, 0);
-    
-    int cashe = 0;
-    for (size_t i = 0; i < result.size() || cashe; ++i) {
-        result[i] -= cashe + (i < ac_s_bd.size() ? ac_s_bd[i] : 0);
-        if (result[i] < 0) {
-            cashe = 1;
-            result[i] += _base;
+void BigIntegerBatch::addBlock(const BigInteger* lhs, const BigInteger* rhs, BigInteger* out, size_t count,
+                               bool subtract) {
+    size_t width = std::max(laneWidth(lhs, count), laneWidth(rhs, count)) + 1;
+    std::vector<limb> lanes(3 * width * _lanes, 0);
+    limb* a = lanes.data();
+    limb* b = a + width * _lanes;
+    limb* result = b + width * _lanes;
+    pack(a, lhs, count, width);
+    pack(b, rhs, count, width);
+    _lane_kernel(result, a, b, width, subtract ? ~static_cast<limb>(0) : 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (lhs[i]._bits.size() > _max_limbs || rhs[i]._bits.size() > _max_limbs) {
+            out[i] = subtract ? lhs[i] - rhs[i] : lhs[i] + rhs[i];
         }
         else {
-            cashe = 0;
+            unpack(out + i, result + i, 1, width);
         }
     }
-  return result;
 }
 
-void BigInteger::rmInsignNulls() {
-    while (_bits.size() > 1 && _bits.back() == 0) {
-        _bits.pop_back();
+// Limbs of the longest operand that fits in the lanes
+size_t BigIntegerBatch::laneWidth(const BigInteger* values, size_t count) {
+    size_t width = 1;
+    for (size_t i = 0; i < count; ++i) {
+        size_t size = values[i]._bits.size();
+        if (size <= _max_limbs) {
+            width = std::max(width, size);
+        }
     }
-    size = _bits.size();
+    return width;
 }
 
-void BigInteger::shiftRight() {
-
-    if (_bits.size() == 0) {
-        _bits.push_back(0);
-    }
-    else {
-        _bits.insert(_bits.begin(), 0);
+// Writes values[i] into lane i in two's complement, sign-extended to width limbs; operands too
+// long for the lanes are left as zeros
+void BigIntegerBatch::pack(limb* lanes, const BigInteger* values, size_t count, size_t width) {
+    for (size_t i = 0; i < count; ++i) {
+        const limb_vector& bits = values[i]._bits;
+        if (bits.size() > _max_limbs) {
+            continue;
+        }
+        limb fill = values[i]._sign == NEGATIVE ? ~static_cast<limb>(0) : 0;
+        limb cashe = fill & 1;
+        for (size_t k = 0; k < width; ++k) {
+            limb value = ((k < bits.size() ? bits[k] : 0) ^ fill) + cashe;
+            cashe &= value == 0;
+            lanes[k * _lanes + i] = value;
+        }
     }
-    size = _bits.size();
-    return;
 }
 
-std::vector<int> BigInteger::simpleMultiply(const std::vector<int>& A, const std::vector<int>& B) {
-    size_t n = A.size();
-    std::vector<int> result(2 * n, 0);
-    int cashe = 0;
-    long long tmp_num;
-    for (size_t i = 0; i < n; ++i) {
-        for (size_t j = 0; j < n || cashe; ++j) {
-            tmp_num =  cashe + result[i + j] + long(A[i]) * (j >= B.size() ? 0L : long(B[j]));
-            result[i + j] = static_cast<int>(tmp_num % _base);
-            cashe = static_cast<int>(tmp_num / _base);
+// The inverse of pack for lanes 0..count-1 of the block starting at lanes
+void BigIntegerBatch::unpack(BigInteger* out, const limb* lanes, size_t count, size_t width) {
+    for (size_t i = 0; i < count; ++i) {
+        limb fill = 0 - (lanes[(width - 1) * _lanes + i] >> 63);
+        limb cashe = fill & 1;
+        limb value[_max_limbs + 1];
+        size_t size = 1;
+        for (size_t k = 0; k < width; ++k) {
+            value[k] = (lanes[k * _lanes + i] ^ fill) + cashe;
+            cashe &= value[k] == 0;
+            size = value[k] ? k + 1 : size;
         }
+        out[i]._bits.assign(value, value + size);
+        out[i]._sign = value[0] == 0 && size == 1 ? ZERO : fill ? NEGATIVE : POSITIVE;
     }
-    return result;
 }
 
-// _____________________________________AUXILIARY_FUNCTIONS_____________________________________
-BigInteger abs(const BigInteger& num) {
-    BigInteger pos_num(num);
-    pos_num._sign = POSITIVE;
-    return pos_num;
+void BigIntegerBatch::addLanesScalar(limb* result, const limb* lhs, const limb* rhs, size_t width, limb flip) {
+    for (size_t i = 0; i < _lanes; ++i) {
+        limb cashe = flip & 1;
+        for (size_t k = 0; k < width; ++k) {
+            limb a = lhs[k * _lanes + i];
+            limb sum = a + (rhs[k * _lanes + i] ^ flip);
+            limb carry = sum < a;
+            result[k * _lanes + i] = sum + cashe;
+            cashe = carry | (result[k * _lanes + i] < sum);
+        }
+    }
 }
 
-BigInteger GreatestCommonDivisor(BigInteger a, BigInteger b) {
-    while (b) {
-       a %= b;
-       std::swap(a, b);
+#ifdef BIGINTEGER_X86_SIMD
+// Four lanes per register: the carries stay in a register of 0/1 lanes while the limbs go up
+__attribute__((target("avx2")))
+void BigIntegerBatch::addLanesAvx2(limb* result, const limb* lhs, const limb* rhs, size_t width, limb flip) {
+    const __m256i sign_bit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(flip));
+    for (size_t i = 0; i < _lanes; i += 4) {
+        __m256i cashe = _mm256_set1_epi64x(static_cast<long long>(flip & 1));
+        for (size_t k = 0; k < width; ++k) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + k * _lanes + i));
+            __m256i b = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + k * _lanes + i)), mask);
+            __m256i sum = _mm256_add_epi64(a, b);
+            __m256i carry = _mm256_cmpgt_epi64(_mm256_xor_si256(a, sign_bit), _mm256_xor_si256(sum, sign_bit));
+            __m256i total = _mm256_add_epi64(sum, cashe);
+            carry = _mm256_or_si256(carry, _mm256_cmpgt_epi64(_mm256_xor_si256(sum, sign_bit),
+                                                              _mm256_xor_si256(total, sign_bit)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + k * _lanes + i), total);
+            cashe = _mm256_srli_epi64(carry, 63);
+        }
     }
-    return a;
 }
+#endif
 
 // _____________________________________RATIONAL_____________________________________
 class Rational {
@@ -557,13 +3987,55 @@ public:
              BigInteger new_denominator);
     
     explicit operator double() const {
-        return std::stod(asDecimal(20));
+        return toDouble();
     }
-    
+    // Nearest value, ties to even, down to subnormals and up to infinity
+    double toDouble() const;
+    long double toLongDouble() const;
+
     std::string toString() const;
+    // Truncated toward zero to precision digits after the point
     std::string asDecimal(size_t precision = 0) const;
 
+    // Endless input iterator over the decimal digits of |x| after the point. Digits are produced in
+    // blocks about as long as the denominator, one division per block rather than one per digit.
+    class DigitIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = char;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const char*;
+        using reference = const char&;
+
+        reference operator * () const {return _block[_index];}
+        DigitIterator& operator ++ ();
+        DigitIterator operator ++ (int);
+        // Digits stepped over so far
+        size_t position() const {return _position;}
+        friend bool operator == (const DigitIterator& lhs, const DigitIterator& rhs) {
+            return lhs._position == rhs._position;
+        }
+        friend bool operator != (const DigitIterator& lhs, const DigitIterator& rhs) {
+            return !(lhs == rhs);
+        }
+    private:
+        friend class Rational;
+        DigitIterator(BigInteger remainder, const BigInteger& denominator);
+        void refill();
+
+        BigInteger _remainder;
+        BigInteger _denominator;
+        // 10^_block_digits
+        BigInteger _scale;
+        size_t _block_digits;
+        std::string _block;
+        size_t _index;
+        size_t _position;
+    };
+    DigitIterator fractionDigits() const;
+
     Rational operator - () const;
+    Rational(const Rational& other) = default;
     Rational& operator = (const Rational& other);
     Rational& operator += (const Rational& rhs);
     Rational& operator -= (const Rational& rhs);
@@ -582,37 +4054,106 @@ public:
 
     friend std::istream& operator >> (std::istream& is, Rational& r);
     friend std::ostream& operator << (std::ostream& os, const Rational& r);
+    friend class RationalMatrix;
+
+    // Brings the fraction to lowest terms
+    Rational& normalize();
+    // With a nonzero max_limbs, +, -, * and / keep unreduced fractions while the numerator and denominator
+    // stay within max_limbs limbs, and toString and normalize() reduce on demand. Past the bound results
+    // are reduced as with 0, the default, which reduces every result. Const operations never modify their
+    // operands: toString and the operators reduce copies, so normalize() long-lived values to avoid that.
+    static void setReductionBound(size_t max_limbs);
 private:
+    // The denominator is always positive; both are coprime once _reduced is set
     BigInteger numerator;
     BigInteger denominator;
+    bool _reduced;
+    static size_t _reduction_bound;
+
+    // Takes a positive denominator as is, reducing only if the fraction is over the bound
+    Rational(BigInteger new_numerator, BigInteger new_denominator, bool reduced);
 
     void Negate();
+    void reduce();
+    bool overBound() const;
+    // Whether a result of limbs limbs may be left unreduced
+    static bool withinBound(size_t limbs) {return _reduction_bound != 0 && limbs <= _reduction_bound;}
+    static size_t limbs(const BigInteger& num) {return num._bits.size();}
+    // -1, 0 or 1 as lhs is less than, equal to or greater than rhs, reduced or not
+    static int compare(const Rational& lhs, const Rational& rhs);
+    template <class Float>
+    Float toFloating() const;
+    // |num| / den * 2^scale correctly rounded, den positive
+    template <class Float>
+    static Float roundQuotient(const BigInteger& num, const BigInteger& den, ll scale);
+    // Once an operand has _estimate_threshold limbs, toFloating first rounds quotients of the top _estimate_limbs
+    static constexpr size_t _estimate_limbs = 4;
+    static constexpr size_t _estimate_threshold = 32;
 };
 
+size_t Rational::_reduction_bound = 0;
+
 // _____________________________________CONSTRUCTORS_____________________________________
 Rational::Rational() : numerator(0),
-                       denominator(1) {}
+                       denominator(1),
+                       _reduced(true) {}
 
 Rational::Rational(int new_numerator) : numerator(new_numerator),
-                                        denominator(1) {}
+                                        denominator(1),
+                                        _reduced(true) {}
 
 Rational::Rational(BigInteger new_numerator) : numerator(new_numerator),
-                                               denominator(1) {}
+                                               denominator(1),
+                                               _reduced(true) {}
 
-Rational::Rational(BigInteger new_numerator, BigInteger new_denominator) {
-  const BigInteger gcd = GreatestCommonDivisor(new_numerator, new_denominator);
-  numerator = new_numerator / gcd;
-  denominator = new_denominator / gcd;
+Rational::Rational(BigInteger new_numerator, BigInteger new_denominator) : numerator(std::move(new_numerator)),
+                                                                           denominator(std::move(new_denominator)),
+                                                                           _reduced(false) {
   if (denominator < 0) {
     denominator.Negate();
     numerator.Negate();
   }
+  reduce();
+}
+
+Rational::Rational(BigInteger new_numerator, BigInteger new_denominator, bool reduced)
+    : numerator(std::move(new_numerator)),
+      denominator(std::move(new_denominator)),
+      _reduced(reduced) {
+    if (!_reduced && (_reduction_bound == 0 || overBound())) {
+        reduce();
+    }
 }
 
 void Rational::Negate() {
     numerator.Negate();
 }
 
+void Rational::reduce() {
+    if (_reduced) {
+        return;
+    }
+    const BigInteger gcd = GreatestCommonDivisor(numerator, denominator);
+    if (gcd != 1) {
+        numerator /= gcd;
+        denominator /= gcd;
+    }
+    _reduced = true;
+}
+
+bool Rational::overBound() const {
+    return std::max(limbs(numerator), limbs(denominator)) > _reduction_bound;
+}
+
+Rational& Rational::normalize() {
+    reduce();
+    return *this;
+}
+
+void Rational::setReductionBound(size_t max_limbs) {
+    _reduction_bound = max_limbs;
+}
+
 // _____________________________________ARITHMETIC_OPERATORS_____________________________________
 Rational Rational::operator - () const {
     Rational new_num(*this);
@@ -623,9 +4164,11 @@ Rational Rational::operator - () const {
 Rational& Rational::operator = (const Rational& other) {
     numerator = other.numerator;
     denominator = other.denominator;
+    _reduced = other._reduced;
     return *this;
 }
 
+
 Rational& Rational::operator += (const Rational& rhs) {
     *this = *this + rhs;
     return *this;
@@ -648,24 +4191,84 @@ Rational& Rational::operator /= (const Rational& rhs) {
     return *this;
 }
 
+// For reduced a/b and c/d Henrici's method only divides by gcd(b, d) and by gcd(t, gcd(b, d)),
+// which are usually far smaller than the gcd of the full cross sum
 Rational operator + (const Rational& lhs, const Rational& rhs) {
-  return {lhs.numerator * rhs.denominator + rhs.numerator * lhs.denominator,
-          lhs.denominator * rhs.denominator};
+    const BigInteger& a = lhs.numerator;
+    const BigInteger& b = lhs.denominator;
+    const BigInteger& c = rhs.numerator;
+    const BigInteger& d = rhs.denominator;
+    if (b == d) {
+        return {a + c, b, b == 1};
+    }
+    // a + c/d and a/b + c stay coprime to the denominator
+    if (b == 1) {
+        return {a * d + c, d, rhs._reduced};
+    }
+    if (d == 1) {
+        return {a + c * b, b, lhs._reduced};
+    }
+    const size_t cross = std::max(Rational::limbs(a) + Rational::limbs(d), Rational::limbs(c) + Rational::limbs(b));
+    if (Rational::withinBound(std::max(cross + 1, Rational::limbs(b) + Rational::limbs(d)))) {
+        return {a * d + c * b, b * d, false};
+    }
+    // Henrici's method needs reduced operands
+    if (!lhs._reduced) {
+        return Rational(lhs).normalize() + rhs;
+    }
+    if (!rhs._reduced) {
+        return lhs + Rational(rhs).normalize();
+    }
+    const BigInteger d1 = GreatestCommonDivisor(b, d);
+    if (d1 == 1) {
+        return {a * d + c * b, b * d, true};
+    }
+    const BigInteger b1 = b / d1;
+    BigInteger t = a * (d / d1) + c * b1;
+    const BigInteger d2 = GreatestCommonDivisor(t, d1);
+    if (d2 == 1) {
+        return {std::move(t), b1 * d, true};
+    }
+    return {t / d2, b1 * (d / d2), true};
 }
 
 Rational operator - (const Rational& lhs, const Rational& rhs) {
   return lhs + (-rhs);
 }
 
+// For reduced a/b and c/d Knuth's method cancels gcd(a, d) and gcd(c, b) before multiplying,
+// two gcds of half the size of the one the product would need
 Rational operator * (const Rational& lhs, const Rational& rhs) {
-  return {
-      lhs.numerator * rhs.numerator,
-      lhs.denominator * rhs.denominator
-  };
+    const BigInteger& a = lhs.numerator;
+    const BigInteger& b = lhs.denominator;
+    const BigInteger& c = rhs.numerator;
+    const BigInteger& d = rhs.denominator;
+    const size_t straight = std::max(Rational::limbs(a) + Rational::limbs(c), Rational::limbs(b) + Rational::limbs(d));
+    if (Rational::withinBound(straight)) {
+        return {a * c, b * d, false};
+    }
+    if (!lhs._reduced) {
+        return Rational(lhs).normalize() * rhs;
+    }
+    if (!rhs._reduced) {
+        return lhs * Rational(rhs).normalize();
+    }
+    if (b == 1 && d == 1) {
+        return {a * c, 1, true};
+    }
+    const BigInteger g1 = d == 1 ? BigInteger(1) : GreatestCommonDivisor(a, d);
+    const BigInteger g2 = b == 1 ? BigInteger(1) : GreatestCommonDivisor(c, b);
+    return {(g1 == 1 ? a : a / g1) * (g2 == 1 ? c : c / g2),
+            (g2 == 1 ? b : b / g2) * (g1 == 1 ? d : d / g1), true};
 }
 
 Rational operator / (const Rational& lhs, const Rational& rhs) {
-  return lhs * Rational(rhs.denominator, rhs.numerator);
+    Rational reciprocal(rhs.denominator, rhs.numerator, rhs._reduced);
+    if (reciprocal.denominator < 0) {
+        reciprocal.numerator.Negate();
+        reciprocal.denominator.Negate();
+    }
+    return lhs * reciprocal;
 }
 
 // _____________________________________STREAM_OPERATORS_____________________________________
@@ -684,6 +4287,9 @@ std::ostream& operator << (std::ostream& os, const Rational& r) {
 }
 
 std::string Rational::toString() const {
+    if (!_reduced) {
+        return Rational(*this).normalize().toString();
+    }
     std::string s = numerator.toString();
     if (denominator == 1) {
         return s;
@@ -693,33 +4299,189 @@ std::string Rational::toString() const {
     return s;
 }
 
+// One division of |numerator| * 10^precision, the digits split around the point afterwards
 std::string Rational::asDecimal(size_t precision) const {
     std::string s;
-    if (*this < 0) s += '-';
-
-    BigInteger num = abs(numerator);
-    BigInteger den = denominator;
-
-    s += (num / den).toString();
+    if (numerator < 0) {
+        s += '-';
+    }
+    BigInteger scaled = abs(numerator);
     if (precision > 0) {
-        s += '.';
+        scaled *= pow(BigInteger(10), precision);
+    }
+    std::string digits = (scaled / denominator).toString();
+    if (precision == 0) {
+        return s + digits;
     }
-    for (size_t i = 0; i < precision; ++i) {
-        num %= den;
-        num *= 10;
-        s += (num / den).toString();
+    if (digits.size() <= precision) {
+        digits.insert(0, precision + 1 - digits.size(), '0');
     }
+    s.append(digits, 0, digits.size() - precision);
+    s += '.';
+    s.append(digits, digits.size() - precision, precision);
     return s;
 }
 
+Rational::DigitIterator Rational::fractionDigits() const {
+    return DigitIterator(abs(numerator) % denominator, denominator);
+}
+
+Rational::DigitIterator::DigitIterator(BigInteger remainder, const BigInteger& denominator)
+    : _remainder(std::move(remainder)),
+      _denominator(denominator),
+      _index(0),
+      _position(0) {
+    _block_digits = std::max<size_t>(BigInteger::_dec_digits,
+                                     BigInteger::bitLength(denominator._bits) * 30103 / 100000 + 1);
+    _scale = pow(BigInteger(10), _block_digits);
+    refill();
+}
+
+// The next _block_digits digits are floor(remainder * 10^_block_digits / denominator), zero-padded
+void Rational::DigitIterator::refill() {
+    BigInteger quotient;
+    _remainder *= _scale;
+    BigInteger::divmod(_remainder, _denominator, quotient, _remainder);
+    _block = quotient.toString();
+    _block.insert(0, _block_digits - _block.size(), '0');
+    _index = 0;
+}
+
+Rational::DigitIterator& Rational::DigitIterator::operator ++ () {
+    ++_position;
+    if (++_index == _block_digits) {
+        refill();
+    }
+    return *this;
+}
+
+Rational::DigitIterator Rational::DigitIterator::operator ++ (int) {
+    DigitIterator old = *this;
+    ++*this;
+    return old;
+}
+
+double Rational::toDouble() const {
+    return toFloating<double>();
+}
+
+long double Rational::toLongDouble() const {
+    return toFloating<long double>();
+}
+
+// Long operands are cut to their top _estimate_limbs limbs, which bounds |x| between two short quotients.
+// Rounding is monotone, so when both bounds round to the same value so does |x|; only values within
+// about 2^-190 of a rounding boundary fall back to the exact quotient of the full operands.
+template <class Float>
+Float Rational::toFloating() const {
+    if (numerator._sign == ZERO) {
+        return 0;
+    }
+    const Float sign = numerator._sign == NEGATIVE ? -1 : 1;
+    if (std::max(limbs(numerator), limbs(denominator)) < _estimate_threshold) {
+        return sign * roundQuotient<Float>(numerator, denominator, 0);
+    }
+    const size_t cut_num = limbs(numerator) - std::min(limbs(numerator), _estimate_limbs);
+    const size_t cut_den = limbs(denominator) - std::min(limbs(denominator), _estimate_limbs);
+    const BigInteger top_num(limb_vector(numerator._bits.begin() + cut_num, numerator._bits.end()), POSITIVE);
+    const BigInteger top_den(limb_vector(denominator._bits.begin() + cut_den, denominator._bits.end()), POSITIVE);
+    const ll scale = 64 * (static_cast<ll>(cut_num) - static_cast<ll>(cut_den));
+    const Float low = roundQuotient<Float>(top_num, cut_den > 0 ? top_den + 1 : top_den, scale);
+    const Float high = roundQuotient<Float>(cut_num > 0 ? top_num + 1 : top_num, top_den, scale);
+    if (low == high) {
+        return sign * low;
+    }
+    return sign * roundQuotient<Float>(numerator, denominator, 0);
+}
+
+// Divides with the binary point moved so that the quotient has digits + 2 or digits + 3 bits, where
+// digits is the mantissa width or fewer for subnormals. The quotient's low bits and the remainder then
+// decide the rounding exactly; ldexp of the rounded mantissa is exact.
+template <class Float>
+Float Rational::roundQuotient(const BigInteger& num, const BigInteger& den, ll scale) {
+    using limits = std::numeric_limits<Float>;
+    // 2^(e - 1) <= |x| < 2^(e + 1)
+    const ll e = static_cast<ll>(BigInteger::bitLength(num._bits)) -
+                 static_cast<ll>(BigInteger::bitLength(den._bits)) + scale;
+    if (e > limits::max_exponent + 1) {
+        return limits::infinity();
+    }
+    if (e < limits::min_exponent - limits::digits - 2) {
+        return 0;
+    }
+    const ll shift = limits::digits + 2 - e;
+    // The quotient is floor(|x| * 2^shift)
+    const ll total = shift + scale;
+    BigInteger quotient;
+    BigInteger remainder;
+    if (total >= 0) {
+        BigInteger::divmod(abs(num) << static_cast<size_t>(total), den, quotient, remainder);
+    }
+    else {
+        BigInteger::divmod(abs(num), den << static_cast<size_t>(-total), quotient, remainder);
+    }
+    dlimb q = quotient._bits[0];
+    if (quotient._bits.size() > 1) {
+        q |= static_cast<dlimb>(quotient._bits[1]) << 64;
+    }
+    const ll bits = static_cast<ll>(BigInteger::bitLength(quotient._bits));
+    // |x| lies in [2^exponent, 2^(exponent + 1)); below the normal range the mantissa loses bits
+    const ll exponent = bits - 1 - shift;
+    const ll keep = limits::digits - std::max<ll>(0, limits::min_exponent - 1 - exponent);
+    const ll drop = bits - keep;
+    if (drop > bits) {
+        return 0;
+    }
+    dlimb mantissa = q >> drop;
+    const dlimb rest = q - (mantissa << drop);
+    const dlimb half = static_cast<dlimb>(1) << (drop - 1);
+    if (rest > half || (rest == half && (remainder._sign != ZERO || (mantissa & 1)))) {
+        ++mantissa;
+    }
+    return std::ldexp(static_cast<Float>(mantissa), static_cast<int>(drop - shift));
+}
+
 // _____________________________________RELATION_OPERATORS_____________________________________
+// Signs and bit lengths settle most pairs; the rest cross-multiply, and nothing needs a gcd
+int Rational::compare(const Rational& lhs, const Rational& rhs) {
+    const Sign sign = lhs.numerator._sign;
+    if (sign != rhs.numerator._sign) {
+        return sign < rhs.numerator._sign ? -1 : 1;
+    }
+    if (sign == ZERO) {
+        return 0;
+    }
+    int cmp;
+    if (lhs.denominator == rhs.denominator) {
+        cmp = BigInteger::cmpVec(lhs.numerator._bits, rhs.numerator._bits);
+    }
+    else {
+        // |a| * |d| has bitLength(a) + bitLength(d) bits or one less
+        size_t left = BigInteger::bitLength(lhs.numerator._bits) + BigInteger::bitLength(rhs.denominator._bits);
+        size_t right = BigInteger::bitLength(rhs.numerator._bits) + BigInteger::bitLength(lhs.denominator._bits);
+        if (left > right + 1) {
+            cmp = 1;
+        }
+        else if (right > left + 1) {
+            cmp = -1;
+        }
+        else {
+            cmp = BigInteger::cmpVec((lhs.numerator * rhs.denominator)._bits, (rhs.numerator * lhs.denominator)._bits);
+        }
+    }
+    return sign == POSITIVE ? cmp : -cmp;
+}
+
 bool operator == (const Rational& lhs, const Rational& rhs) {
-    return lhs.numerator == rhs.numerator &&
-        lhs.denominator == rhs.denominator;
+    if (lhs._reduced && rhs._reduced) {
+        return lhs.numerator == rhs.numerator &&
+            lhs.denominator == rhs.denominator;
+    }
+    return Rational::compare(lhs, rhs) == 0;
 }
 
 bool operator < (const Rational& lhs, const Rational& rhs) {
-    return (lhs - rhs).numerator < 0;
+    return Rational::compare(lhs, rhs) < 0;
 }
 
 bool operator != (const Rational& lhs, const Rational& rhs) {
@@ -737,3 +4499,267 @@ bool operator <= (const Rational& lhs, const Rational& rhs) {
 bool operator >= (const Rational& lhs, const Rational& rhs) {
     return !(lhs < rhs);
 }
+
+// _____________________________________RATIONAL_MATRIX_____________________________________
+// Dense matrix of Rationals, stored row by row as BigInteger numerators over one positive common
+// denominator. Elimination follows Bareiss' fraction-free scheme: every intermediate entry is a minor of
+// the input, so entries grow linearly with the step rather than exponentially, and every division is
+// exact. With BigInteger::setThreadPool the row updates of each step are spread over the pool.
+// Shapes that do not fit together throw std::invalid_argument.
+class RationalMatrix {
+public:
+    // rows x cols zeros
+    RationalMatrix(size_t rows, size_t cols);
+    // Equally long rows
+    RationalMatrix(const std::vector<std::vector<Rational>>& rows);
+    // rows * cols numerators row by row over a nonzero denominator
+    RationalMatrix(size_t rows, size_t cols, std::vector<BigInteger> numerators, BigInteger denominator = 1);
+    static RationalMatrix identity(size_t n);
+
+    size_t rows() const {return _rows;}
+    size_t cols() const {return _cols;}
+    Rational at(size_t row, size_t col) const;
+    const BigInteger& numerator(size_t row, size_t col) const {return _entries[row * _cols + col];}
+    const BigInteger& denominator() const {return _denominator;}
+
+    // Square matrices only
+    Rational determinant() const;
+    size_t rank() const;
+    // For a square nonsingular matrix sets solution to the one with *this * solution == rhs and returns
+    // true; returns false and leaves solution alone if the matrix is singular. Square matrices only, and
+    // rhs needs as many rows as *this.
+    bool solve(const RationalMatrix& rhs, RationalMatrix& solution) const;
+    bool solve(const std::vector<Rational>& rhs, std::vector<Rational>& solution) const;
+    bool inverse(RationalMatrix& result) const;
+
+private:
+    size_t _rows;
+    size_t _cols;
+    std::vector<BigInteger> _entries;
+    BigInteger _denominator;
+
+    // Divides the entries and the denominator by their common gcd and makes the denominator positive
+    void reduce();
+    // Fraction-free elimination of the rows x width matrix m to row echelon form, with pivots taken from
+    // its first pivot_cols columns. Returns the number of pivots; negate flips with every row swap.
+    static size_t eliminate(std::vector<BigInteger>& m, size_t rows, size_t width, size_t pivot_cols, bool& negate);
+};
+
+RationalMatrix::RationalMatrix(size_t rows, size_t cols) : _rows(rows),
+                                                          _cols(cols),
+                                                          _entries(rows * cols),
+                                                          _denominator(1) {}
+
+RationalMatrix::RationalMatrix(const std::vector<std::vector<Rational>>& rows)
+    : _rows(rows.size()),
+      _cols(rows.empty() ? 0 : rows[0].size()),
+      _denominator(1) {
+    for (const std::vector<Rational>& row : rows) {
+        if (row.size() != _cols) {
+            throw std::invalid_argument("RationalMatrix: rows of different lengths");
+        }
+    }
+    // The least common denominator keeps the entries coprime to it overall when the inputs are reduced
+    for (const std::vector<Rational>& row : rows) {
+        for (const Rational& value : row) {
+            if (value.denominator != _denominator && value.denominator != 1) {
+                _denominator *= value.denominator / GreatestCommonDivisor(_denominator, value.denominator);
+            }
+        }
+    }
+    _entries.reserve(_rows * _cols);
+    for (const std::vector<Rational>& row : rows) {
+        for (const Rational& value : row) {
+            _entries.push_back(value.denominator == _denominator ? value.numerator
+                                                                 : value.numerator * (_denominator / value.denominator));
+        }
+    }
+}
+
+RationalMatrix::RationalMatrix(size_t rows, size_t cols, std::vector<BigInteger> numerators, BigInteger denominator)
+    : _rows(rows),
+      _cols(cols),
+      _entries(std::move(numerators)),
+      _denominator(std::move(denominator)) {
+    if (_entries.size() != rows * cols) {
+        throw std::invalid_argument("RationalMatrix: numerator count is not rows * cols");
+    }
+    if (_denominator._sign == ZERO) {
+        throw std::invalid_argument("RationalMatrix: zero denominator");
+    }
+    reduce();
+}
+
+RationalMatrix RationalMatrix::identity(size_t n) {
+    RationalMatrix result(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        result._entries[i * n + i] = 1;
+    }
+    return result;
+}
+
+Rational RationalMatrix::at(size_t row, size_t col) const {
+    return Rational(numerator(row, col), _denominator);
+}
+
+void RationalMatrix::reduce() {
+    if (_denominator < 0) {
+        _denominator.Negate();
+        for (BigInteger& entry : _entries) {
+            entry.Negate();
+        }
+    }
+    BigInteger gcd = _denominator;
+    for (const BigInteger& entry : _entries) {
+        if (gcd == 1) {
+            return;
+        }
+        gcd = GreatestCommonDivisor(std::move(gcd), entry);
+    }
+    if (gcd == 1) {
+        return;
+    }
+    _denominator = divExact(_denominator, gcd);
+    for (BigInteger& entry : _entries) {
+        entry = divExact(entry, gcd);
+    }
+}
+
+size_t RationalMatrix::eliminate(std::vector<BigInteger>& m, size_t rows, size_t width, size_t pivot_cols,
+                                 bool& negate) {
+    BigInteger previous = 1;
+    size_t rank = 0;
+    for (size_t col = 0; col < pivot_cols && rank < rows; ++col) {
+        size_t pivot_row = rank;
+        while (pivot_row < rows && m[pivot_row * width + col]._sign == ZERO) {
+            ++pivot_row;
+        }
+        if (pivot_row == rows) {
+            continue;
+        }
+        if (pivot_row != rank) {
+            std::swap_ranges(m.begin() + pivot_row * width, m.begin() + (pivot_row + 1) * width,
+                             m.begin() + rank * width);
+            negate = !negate;
+        }
+        const BigInteger* pivot = &m[rank * width];
+        const BigInteger& p = pivot[col];
+        const bool unit = previous == 1;
+        // Row i becomes (p * row_i - m[i][col] * pivot_row) / previous right of col, an exact division
+        auto update = [&](size_t i) {
+            BigInteger* row = &m[i * width];
+            BigInteger product;
+            for (size_t j = col + 1; j < width; ++j) {
+                row[j] *= p;
+                if (row[col]._sign != ZERO && pivot[j]._sign != ZERO) {
+                    product = row[col] * pivot[j];
+                    row[j] -= product;
+                }
+                if (!unit) {
+                    row[j] = divExact(row[j], previous);
+                }
+            }
+            row[col] = 0;
+        };
+        const size_t count = rows - rank - 1;
+        BigInteger::forkEach(count * (width - col) * p._bits.size(), count, [&](size_t k) {update(rank + 1 + k);});
+        previous = p;
+        ++rank;
+    }
+    return rank;
+}
+
+Rational RationalMatrix::determinant() const {
+    if (_rows != _cols) {
+        throw std::invalid_argument("RationalMatrix::determinant: matrix is not square");
+    }
+    std::vector<BigInteger> m = _entries;
+    bool negate = false;
+    if (eliminate(m, _rows, _cols, _cols, negate) < _rows) {
+        return Rational(0);
+    }
+    BigInteger det = _rows == 0 ? BigInteger(1) : m.back();
+    if (negate) {
+        det.Negate();
+    }
+    return Rational(std::move(det), pow(_denominator, _rows));
+}
+
+size_t RationalMatrix::rank() const {
+    std::vector<BigInteger> m = _entries;
+    bool negate = false;
+    return eliminate(m, _rows, _cols, _cols, negate);
+}
+
+// With A = M / a and B = N / b, X = A^-1 * B is det(M) * M^-1 * N times a over det(M) * b. The middle
+// factor is integral by Cramer's rule; after eliminating [M | N] to [U | Y] it comes out of fraction-free
+// back substitution, row i of a column being (det(M) * Y_i - sum over j > i of U_ij * X_j) / U_ii exactly.
+bool RationalMatrix::solve(const RationalMatrix& rhs, RationalMatrix& solution) const {
+    if (_rows != _cols) {
+        throw std::invalid_argument("RationalMatrix::solve: matrix is not square");
+    }
+    if (rhs._rows != _rows) {
+        throw std::invalid_argument("RationalMatrix::solve: right-hand side has a different number of rows");
+    }
+    const size_t n = _rows;
+    const size_t width = n + rhs._cols;
+    std::vector<BigInteger> m(n * width);
+    for (size_t i = 0; i < n; ++i) {
+        std::copy(_entries.begin() + i * n, _entries.begin() + (i + 1) * n, m.begin() + i * width);
+        std::copy(rhs._entries.begin() + i * rhs._cols, rhs._entries.begin() + (i + 1) * rhs._cols,
+                  m.begin() + i * width + n);
+    }
+    bool negate = false;
+    if (eliminate(m, n, width, n, negate) < n) {
+        return false;
+    }
+    const BigInteger det = n == 0 ? BigInteger(1) : m[(n - 1) * width + n - 1];
+    BigInteger::forkEach(n * n * rhs._cols * det._bits.size(), rhs._cols, [&](size_t k) {
+        const size_t col = n + k;
+        BigInteger product;
+        for (size_t i = n; i-- > 0;) {
+            const BigInteger* row = &m[i * width];
+            BigInteger& x = m[i * width + col];
+            x *= det;
+            for (size_t j = i + 1; j < n; ++j) {
+                if (row[j]._sign != ZERO) {
+                    product = row[j] * m[j * width + col];
+                    x -= product;
+                }
+            }
+            x = divExact(x, row[i]);
+        }
+    });
+    std::vector<BigInteger> numerators;
+    numerators.reserve(n * rhs._cols);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = n; j < width; ++j) {
+            numerators.push_back(m[i * width + j] * _denominator);
+        }
+    }
+    BigInteger denominator = det * rhs._denominator;
+    solution = RationalMatrix(n, rhs._cols, std::move(numerators), std::move(denominator));
+    return true;
+}
+
+bool RationalMatrix::solve(const std::vector<Rational>& rhs, std::vector<Rational>& solution) const {
+    std::vector<std::vector<Rational>> rows;
+    rows.reserve(rhs.size());
+    for (const Rational& value : rhs) {
+        rows.emplace_back(1, value);
+    }
+    RationalMatrix result(0, 0);
+    if (!solve(RationalMatrix(rows), result)) {
+        return false;
+    }
+    solution.clear();
+    solution.reserve(result._rows);
+    for (size_t i = 0; i < result._rows; ++i) {
+        solution.push_back(result.at(i, 0));
+    }
+    return true;
+}
+
+bool RationalMatrix::inverse(RationalMatrix& result) const {
+    return solve(identity(_rows), result);
+}